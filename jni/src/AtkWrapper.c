@@ -26,6 +26,12 @@
 #include "jawutil.h"
 #include "jawimpl.h"
 #include "jawtoplevel.h"
+#include "jawstringpool.h"
+#include "jawevent.h"
+#include "jawtrace.h"
+#include "jawring.h"
+#include "jawprefetch.h"
+#include "jawsnapshot.h"
 
 #define KEY_DISPATCH_NOT_DISPATCHED	0
 #define KEY_DISPATCH_CONSUMED		1
@@ -45,16 +51,52 @@ struct _DummyDispatch
 	GDestroyNotify destroy;
 };
 
-gboolean jaw_debug = FALSE;
+// at-spi2-atk lets us pick the context its IPC runs on
+typedef void (*JawSetEventContextFunc) (GMainContext *context);
 
-GMutex *atk_bridge_mutex = NULL;
-GCond *atk_bridge_cond = NULL;
+gboolean jaw_debug = FALSE;
 
 GMutex *key_dispatch_mutex = NULL;
 GCond *key_dispatch_cond = NULL;
 static gint key_dispatch_result = KEY_DISPATCH_NOT_DISPATCHED;
 static gboolean (*origin_g_idle_dispatch) (GSource*, GSourceFunc, gpointer);
 
+// Event records kept for reuse instead of going back to malloc
+#define CALLBACK_PARA_POOL_SIZE	256
+
+typedef struct _CallbackParaStats {
+	guint64 n_allocated;
+	guint64 n_reused;
+	guint64 n_freed;	// released while the pool was full
+	guint peak_pooled;
+	guint64 n_global_refs;
+	guint64 n_shared_refs;
+} CallbackParaStats;
+
+static GMutex *paraPoolMutex = NULL;
+static GTrashStack *paraPool = NULL;
+static guint paraPoolSize = 0;
+static CallbackParaStats paraStats;
+
+// JAW_LAZY_CHILDREN=1, added children get a wrapper once an AT asks for them
+static gboolean lazy_children = FALSE;
+static guint64 n_children_wrapped = 0;
+static guint64 n_children_deferred = 0;
+
+// With JAW_DEBUG, the last key event string seen for each keyval, to count
+// keystrokes whose Java String was not built for them
+#define KEY_STRING_SLOTS	256
+static jweak keyStrings[KEY_STRING_SLOTS];
+static guint64 n_key_events = 0;
+static guint64 n_key_strings_shared = 0;
+// Parents with a children refresh queued, only used on the main loop
+static GHashTable *lazyRefreshKeys = NULL;
+
+static void signal_table_init (void);
+static void publish_interest (void);
+static void callback_para_dump_stats (void);
+static void consume_ring_record (JNIEnv *jniEnv, const JawRingRecord *record, guint slot);
+
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *javaVM, void *reserve) {
 	globalJvm = javaVM;
 	return JNI_VERSION_1_2;
@@ -63,6 +105,29 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *javaVM, void *reserve) {
 JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *javaVM, void *reserve) {
 }
 
+static void jaw_exit_func ()
+{
+	if (jaw_debug) {
+		jaw_string_pool_dump_stats();
+		jaw_event_queue_dump_stats();
+		jaw_ring_dump_stats();
+		jaw_trace_dump_stats();
+		callback_para_dump_stats();
+		jaw_impl_dump_virtual_stats();
+		jaw_impl_dump_helper_stats();
+		jaw_prefetch_dump_stats();
+		jaw_snapshot_dump_stats();
+		g_printerr("Children added: %" G_GUINT64_FORMAT " wrapped, %"
+				G_GUINT64_FORMAT " deferred\n",
+				n_children_wrapped, n_children_deferred);
+		g_printerr("Key events: %" G_GUINT64_FORMAT " dispatched, %"
+				G_GUINT64_FORMAT " reused an earlier string\n",
+				n_key_events, n_key_strings_shared);
+	}
+
+	_exit(0);
+}
+
 static gboolean
 jaw_dummy_idle_func (gpointer p)
 {
@@ -91,30 +156,53 @@ jaw_idle_dispatch (GSource    *source,
 	return origin_g_idle_dispatch(source, callback, user_data);
 }
 
-static void jaw_exit_func ()
+/*
+ * Only needed when the bridge cannot be moved off the default context.
+ * Our loop then runs the default context and must not execute the
+ * gdk_threads idles of a GTK look and feel.
+ */
+static void
+jaw_install_idle_filter (void)
 {
-	_exit(0);
+	origin_g_idle_dispatch = g_idle_funcs.dispatch;
+	g_idle_funcs.dispatch = jaw_idle_dispatch;
+
+	// Dummy idle function for jaw_idle_dispatch to get
+	// the address of gdk_threads_dispatch
+	gdk_threads_add_idle(jaw_dummy_idle_func, NULL);
 }
 
-static gboolean
-jaw_load_atk_bridge (gpointer p)
+static GModule*
+jaw_open_atk_bridge (void)
 {
-	g_mutex_lock(atk_bridge_mutex);
-
 	if (!g_module_supported()) {
 		return NULL;
 	}
 
-	GModule *module;
-	module = g_module_open(ATK_BRIDGE_LIB_NAME, G_MODULE_BIND_LAZY);
+	return g_module_open(ATK_BRIDGE_LIB_NAME, G_MODULE_BIND_LAZY);
+}
+
+// Runs on the loop thread, p is the module opened by loadAtkBridge
+static gboolean
+jaw_load_atk_bridge (gpointer p)
+{
+	GModule *module = (GModule*)p;
+	GVoidFunc dl_init;
+	JawSetEventContextFunc set_event_context;
+
 	if (!module) {
-		return NULL;
+		jaw_event_queue_set_ready();
+		return FALSE;
 	}
 
-	GVoidFunc dl_init;
 	if (!g_module_symbol( module, "gnome_accessibility_module_init", (gpointer*)&dl_init)) {
 		g_module_close(module);
-		return NULL;
+		jaw_event_queue_set_ready();
+		return FALSE;
+	}
+
+	if (g_module_symbol( module, "atk_bridge_set_event_context", (gpointer*)&set_event_context)) {
+		(set_event_context)(jaw_event_queue_get_context());
 	}
 
 	(dl_init)();
@@ -124,14 +212,19 @@ jaw_load_atk_bridge (gpointer p)
 		printf("ATK Bridge has been loaded successfully\n");
 	}
 
-	g_cond_signal(atk_bridge_cond);
-	g_mutex_unlock(atk_bridge_mutex);
+	// The bridge listeners are registered now, replay what was buffered
+	jaw_event_queue_set_ready();
 
 	return FALSE;
 }
 
 gpointer jni_main_loop(gpointer data) {
+	GMainContext *context = g_main_loop_get_context( (GMainLoop*)data );
+
+	// Sources created for the thread default context land on our loop
+	g_main_context_push_thread_default(context);
 	g_main_loop_run( (GMainLoop*)data );
+	g_main_context_pop_thread_default(context);
 
 	return NULL;
 }
@@ -139,14 +232,14 @@ gpointer jni_main_loop(gpointer data) {
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_initNativeLibrary(JNIEnv *jniEnv, jclass jClass) {
 	g_type_init();
 
-	// Hook up g_idle_dispatch
-	origin_g_idle_dispatch = g_idle_funcs.dispatch;
-	g_idle_funcs.dispatch = jaw_idle_dispatch;
-
 	const gchar* debug_env = g_getenv("JAW_DEBUG");
 	if (g_strcmp0(debug_env, "1") == 0) {
 		jaw_debug = TRUE;
 	}
+
+	if (g_strcmp0(g_getenv("JAW_LAZY_CHILDREN"), "1") == 0) {
+		lazy_children = TRUE;
+	}
 	
 	// Java app with GTK Look And Feel will load gail
 	// Set NO_GAIL to "1" to prevent gail from executing
@@ -167,36 +260,57 @@ JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_initNativeLibrary
 	}
 
 	jaw_impl_init_mutex();
+	jaw_impl_init_virtual();
+	jaw_util_init_mutex();
+	jaw_string_pool_init();
+
+	jaw_event_queue_init();
+	jaw_trace_init();
+	jaw_prefetch_init();
+	jaw_snapshot_init();
+
+	if (paraPoolMutex == NULL) {
+		paraPoolMutex = g_mutex_new();
+	}
+
+	signal_table_init();
+	jaw_util_set_listener_changed_func(publish_interest);
 
-	atk_bridge_mutex = g_mutex_new();
-	atk_bridge_cond = g_cond_new();
+	jaw_ring_init(consume_ring_record);
 
 	key_dispatch_mutex = g_mutex_new();
 	key_dispatch_cond = g_cond_new();
-
-	// Dummy idle function for jaw_idle_dispatch to get
-	// the address of gdk_threads_dispatch
-	gdk_threads_add_idle(jaw_dummy_idle_func, NULL);
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_loadAtkBridge(JNIEnv *jniEnv, jclass jClass) {
 	// Enable ATK Bridge so we can load it now
 	g_setenv("NO_AT_BRIDGE", "0", TRUE);
 
-	GMainLoop *main_loop = g_main_loop_new( NULL, FALSE );
-	
-	g_idle_add(jaw_load_atk_bridge, NULL);
+	GModule *module = jaw_open_atk_bridge();
+	gpointer set_event_context = NULL;
+	GMainLoop *main_loop;
 
-	// We need to wait for the completion of the loading of ATK Bridge
-	// in order to ensure event listeners in ATK Bridge are properly
-	// registered before any emission of AWT event.
-	g_mutex_lock(atk_bridge_mutex);
+	if (module != NULL) {
+		g_module_symbol(module, "atk_bridge_set_event_context", &set_event_context);
+	}
 
-	GThread *main_loop_thread = g_thread_create( jni_main_loop,
-			(gpointer)main_loop, FALSE, NULL);
+	if (module == NULL || set_event_context != NULL) {
+		// The bridge's IPC runs on the private context with our events,
+		// the default context is left to the application
+		main_loop = g_main_loop_new( jaw_event_queue_get_context(), FALSE );
+	} else {
+		// An older bridge always uses the default context, so the loop
+		// has to run that one and dispatch the private context from it
+		main_loop = g_main_loop_new( NULL, FALSE );
+		jaw_event_queue_attach(g_main_loop_get_context(main_loop));
+		jaw_install_idle_filter();
+	}
+	
+	// The bridge is loaded in the background, events emitted meanwhile
+	// are buffered by jaw_event_post until it is ready
+	jaw_event_idle_add(jaw_load_atk_bridge, module);
 
-	g_cond_wait(atk_bridge_cond, atk_bridge_mutex);
-	g_mutex_unlock(atk_bridge_mutex);
+	g_thread_create( jni_main_loop, (gpointer)main_loop, FALSE, NULL);
 }
 
 typedef enum _SigalType {
@@ -221,55 +335,546 @@ typedef enum _SigalType {
 	Sig_Object_Property_Change_Accessible_Table_Row_Header = 18,
 	Sig_Object_Property_Change_Accessible_Table_Row_Description = 19,
 	Sig_Table_Model_Changed = 20,
-	Sig_Text_Property_Changed = 21
+	Sig_Text_Property_Changed = 21,
+	// Internal, a burst of children changes collapsed by the event queue
+	Sig_Object_Children_Changed_Compacted = 22
 }SignalType;
 
 typedef struct _CallbackPara {
 	jobject global_ac;
+	gint key;
+	JawImpl *impl;
 	gboolean is_toplevel;
 	SignalType signal_id;
-	jobjectArray args;
+	gint int_args[2];
+	jobject child_ac;
+	gint child_key;
 	AtkStateType atk_state;
 	gboolean state_value;
+	guint trace_type;
+	gint64 emit_time;
+	gint64 dispatch_time;
 } CallbackPara;
 
+static void post_signal_para (CallbackPara *para);
+
 static CallbackPara*
-alloc_callback_para (jobject ac)
+take_callback_para (JNIEnv *jniEnv, jobject ac, gint key)
 {
-	CallbackPara *para = g_new(CallbackPara, 1);
-	para->global_ac = ac;
-	para->args = NULL;
+	CallbackPara *para;
+
+	g_mutex_lock(paraPoolMutex);
+	para = (CallbackPara*)g_trash_stack_pop(&paraPool);
+	if (para != NULL) {
+		paraPoolSize--;
+		paraStats.n_reused++;
+	} else {
+		paraStats.n_allocated++;
+	}
+	g_mutex_unlock(paraPoolMutex);
+
+	if (para == NULL) {
+		para = g_new(CallbackPara, 1);
+	}
+
+	// A context that already has a wrapper is kept alive by the wrapper's
+	// own global reference, holding the wrapper is enough
+	para->key = key;
+	para->impl = jaw_impl_ref_instance_by_key(jniEnv, ac, para->key);
+	if (para->impl != NULL) {
+		para->global_ac = JAW_OBJECT(para->impl)->acc_context;
+	} else {
+		para->global_ac = NULL;
+	}
+
+	para->child_ac = NULL;
+	para->trace_type = JAW_TRACE_N_TYPES;
+	para->emit_time = 0;
+	para->dispatch_time = 0;
+
+	g_mutex_lock(paraPoolMutex);
+	if (para->impl != NULL) {
+		paraStats.n_shared_refs++;
+	} else {
+		paraStats.n_global_refs++;
+	}
+	g_mutex_unlock(paraPoolMutex);
 
 	return para;
 }
 
+static CallbackPara*
+alloc_callback_para (JNIEnv *jniEnv, jobject ac, jint key)
+{
+	// Direct events keep their place behind the ring's records
+	jaw_ring_sync(jniEnv);
+
+	CallbackPara *para = take_callback_para(jniEnv, ac, (gint)key);
+
+	if (para->impl == NULL) {
+		para->global_ac = (*jniEnv)->NewGlobalRef(jniEnv, ac);
+	}
+
+	return para;
+}
+
+static JawImpl*
+callback_para_get_instance (JNIEnv *jniEnv, CallbackPara *para)
+{
+	if (para->impl != NULL) {
+		return para->impl;
+	}
+
+	return jaw_impl_get_instance_by_key(jniEnv, para->global_ac, para->key);
+}
+
+static JawImpl*
+callback_para_find_instance (JNIEnv *jniEnv, CallbackPara *para)
+{
+	if (para->impl != NULL) {
+		return para->impl;
+	}
+
+	return jaw_impl_find_instance_by_key(jniEnv, para->global_ac, para->key);
+}
+
+static void
+callback_para_dump_stats (void)
+{
+	guint64 n_taken, n_refs;
+
+	g_mutex_lock(paraPoolMutex);
+	n_taken = paraStats.n_allocated + paraStats.n_reused;
+	n_refs = paraStats.n_global_refs + paraStats.n_shared_refs;
+	g_printerr("Event records: %" G_GUINT64_FORMAT " allocated, %" G_GUINT64_FORMAT
+			" reused (%.1f%%), %" G_GUINT64_FORMAT " freed with the pool full\n",
+			paraStats.n_allocated, paraStats.n_reused,
+			n_taken > 0 ? 100.0 * paraStats.n_reused / n_taken : 0.0,
+			paraStats.n_freed);
+	g_printerr("Event records: %u pooled, peak %u of %d\n",
+			paraPoolSize, paraStats.peak_pooled, CALLBACK_PARA_POOL_SIZE);
+	// Every shared wrapper ref is a NewGlobalRef/DeleteGlobalRef pair saved
+	g_printerr("Event records: %" G_GUINT64_FORMAT " new global refs, %"
+			G_GUINT64_FORMAT " shared wrapper refs (%.1f%%)\n",
+			paraStats.n_global_refs, paraStats.n_shared_refs,
+			n_refs > 0 ? 100.0 * paraStats.n_shared_refs / n_refs : 0.0);
+	g_mutex_unlock(paraPoolMutex);
+}
+
+static void
+callback_para_set_trace (CallbackPara *para, guint trace_type, jlong jWhen)
+{
+	para->trace_type = trace_type;
+	para->emit_time = (gint64)(jWhen / 1000);
+}
+
+static void
+callback_para_dispatched (CallbackPara *para)
+{
+	para->dispatch_time = g_get_monotonic_time();
+	if (para->emit_time != 0) {
+		jaw_trace_record(para->trace_type, JAW_TRACE_STAGE_QUEUE,
+				para->dispatch_time - para->emit_time);
+	}
+}
+
 static void
 free_callback_para (CallbackPara *para)
 {
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	(*jniEnv)->DeleteGlobalRef(jniEnv, para->global_ac);
 
-	if (para->args) {
-		(*jniEnv)->DeleteGlobalRef(jniEnv, para->args);
+	// Dropped events were never dispatched and have nothing to report
+	if (para->dispatch_time != 0 && para->emit_time != 0) {
+		jaw_trace_record(para->trace_type, JAW_TRACE_STAGE_EMIT,
+				g_get_monotonic_time() - para->dispatch_time);
+	}
+
+	if (para->impl != NULL) {
+		g_object_unref(para->impl);
+		para->impl = NULL;
+	} else {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, para->global_ac);
+	}
+	para->global_ac = NULL;
+
+	if (para->child_ac) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, para->child_ac);
+		para->child_ac = NULL;
+	}
+
+	g_mutex_lock(paraPoolMutex);
+	if (paraPoolSize < CALLBACK_PARA_POOL_SIZE) {
+		g_trash_stack_push(&paraPool, para);
+		paraPoolSize++;
+		paraStats.peak_pooled = MAX(paraStats.peak_pooled, paraPoolSize);
+		para = NULL;
+	} else {
+		paraStats.n_freed++;
 	}
+	g_mutex_unlock(paraPoolMutex);
 
 	g_free(para);
 }
 
+static void
+post_callback_para (JawEventLane lane, GSourceFunc func, CallbackPara *para)
+{
+	jaw_event_post_compactable(lane, func, para, (GDestroyNotify)free_callback_para,
+			para->key, 0, NULL);
+}
+
+typedef struct _SignalInfo SignalInfo;
+
+typedef void (*SignalEmitFunc) (JNIEnv *jniEnv, AtkObject *atk_obj,
+		const SignalInfo *info, CallbackPara *para);
+
+/*
+ * One entry per SignalType, resolved once by signal_table_init so that
+ * emitting is a plain g_signal_emit without parsing "name::detail".
+ */
+struct _SignalInfo {
+	const gchar *name;		// signal name, or property for notifications
+	const gchar *detail;
+	GType (*get_type) (void);
+	SignalEmitFunc emit;
+
+	guint signal_id;
+	GQuark detail_quark;
+	GParamSpec *pspec;
+};
+
+static void emit_plain (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_int (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_int_int (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_child_added (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_child_removed (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_active_descendant (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_actions (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_property_change (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_notify (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+static void emit_compacted (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para);
+
+static SignalInfo signalTable[] = {
+	/* Sig_Text_Caret_Moved */
+	{ "text-caret-moved", NULL, atk_text_get_type, emit_int },
+	/* Sig_Text_Property_Changed_Insert */
+	{ "text-changed", "insert", atk_text_get_type, emit_int_int },
+	/* Sig_Text_Property_Changed_Delete */
+	{ "text-changed", "delete", atk_text_get_type, emit_int_int },
+	/* Sig_Text_Property_Changed_Replace */
+	{ NULL, NULL, NULL, NULL },
+	/* Sig_Object_Children_Changed_Add */
+	{ "children-changed", "add", atk_object_get_type, emit_child_added },
+	/* Sig_Object_Children_Changed_Remove */
+	{ "children-changed", "remove", atk_object_get_type, emit_child_removed },
+	/* Sig_Object_Active_Descendant_Changed */
+	{ "active-descendant-changed", NULL, atk_object_get_type, emit_active_descendant },
+	/* Sig_Object_Selection_Changed */
+	{ "selection-changed", NULL, atk_selection_get_type, emit_plain },
+	/* Sig_Object_Visible_Data_Changed */
+	{ "visible-data-changed", NULL, atk_object_get_type, emit_plain },
+	/* Sig_Object_Property_Change_Accessible_Actions */
+	{ "property-change", "accessible-actions", atk_object_get_type, emit_actions },
+	/* Sig_Object_Property_Change_Accessible_Value */
+	{ "accessible-value", NULL, atk_object_get_type, emit_notify },
+	/* Sig_Object_Property_Change_Accessible_Description */
+	{ "accessible-description", NULL, atk_object_get_type, emit_notify },
+	/* Sig_Object_Property_Change_Accessible_Name */
+	{ "accessible-name", NULL, atk_object_get_type, emit_notify },
+	/* Sig_Object_Property_Change_Accessible_Hypertext_Offset */
+	{ "property-change", "accessible-hypertext-offset", atk_object_get_type, emit_property_change },
+	/* Sig_Object_Property_Change_Accessible_Table_Caption */
+	{ "property-change", "accessible-table-caption", atk_object_get_type, emit_property_change },
+	/* Sig_Object_Property_Change_Accessible_Table_Summary */
+	{ "property-change", "accessible-table-summary", atk_object_get_type, emit_property_change },
+	/* Sig_Object_Property_Change_Accessible_Table_Column_Header */
+	{ "property-change", "accessible-table-column-header", atk_object_get_type, emit_property_change },
+	/* Sig_Object_Property_Change_Accessible_Table_Column_Description */
+	{ "property-change", "accessible-table-column-description", atk_object_get_type, emit_property_change },
+	/* Sig_Object_Property_Change_Accessible_Table_Row_Header */
+	{ "property-change", "accessible-table-row-header", atk_object_get_type, emit_property_change },
+	/* Sig_Object_Property_Change_Accessible_Table_Row_Description */
+	{ "property-change", "accessible-table-row-description", atk_object_get_type, emit_property_change },
+	/* Sig_Table_Model_Changed */
+	{ "model-changed", NULL, atk_table_get_type, emit_plain },
+	/* Sig_Text_Property_Changed, turned into insert or delete by Java */
+	{ NULL, NULL, NULL, NULL },
+	/* Sig_Object_Children_Changed_Compacted */
+	{ NULL, NULL, NULL, emit_compacted }
+};
+
+typedef enum _WindowSignal {
+	Win_Create = 0,
+	Win_Destroy,
+	Win_Minimize,
+	Win_Maximize,
+	Win_Restore,
+	Win_Activate,
+	Win_Deactivate,
+	Win_State_Change,
+	Win_Total
+} WindowSignal;
+
+static const gchar *windowSignalNames[Win_Total] = {
+	"create",
+	"destroy",
+	"minimize",
+	"maximize",
+	"restore",
+	"activate",
+	"deactivate",
+	"state-change"
+};
+
+static guint windowSignals[Win_Total];
+static guint stateChangeSignal = 0;
+
+static void
+signal_table_init (void)
+{
+	guint i;
+	GObjectClass *object_class = G_OBJECT_CLASS(g_type_class_ref(ATK_TYPE_OBJECT));
+
+	for (i = 0; i < G_N_ELEMENTS(signalTable); i++) {
+		SignalInfo *info = &signalTable[i];
+		GType type;
+
+		if (info->name == NULL) {
+			continue;
+		}
+
+		if (info->emit == emit_notify) {
+			info->pspec = g_object_class_find_property(object_class, info->name);
+			continue;
+		}
+
+		// Signals of an interface only exist once its default vtable does
+		type = info->get_type();
+		if (G_TYPE_IS_INTERFACE(type)) {
+			g_type_default_interface_ref(type);
+		} else {
+			g_type_class_ref(type);
+		}
+
+		info->signal_id = g_signal_lookup(info->name, type);
+		info->detail_quark = info->detail ? g_quark_from_static_string(info->detail) : 0;
+	}
+
+	stateChangeSignal = g_signal_lookup("state-change", ATK_TYPE_OBJECT);
+
+	g_type_class_ref(JAW_TYPE_OBJECT);
+	for (i = 0; i < Win_Total; i++) {
+		windowSignals[i] = g_signal_lookup(windowSignalNames[i], JAW_TYPE_OBJECT);
+	}
+}
+
+// AtkWrapper.interestMask has one bit per AtkSignal id, and this one
+#define INTEREST_STATE_CHANGE	(1 << 30)
+
+/*
+ * Tell Java which events someone listens to, so it can drop the others
+ * before calling into native code.
+ */
+static void
+publish_interest (void)
+{
+	guint i;
+	jint mask = 0;
+	JNIEnv *jniEnv = jaw_util_get_jni_env();
+
+	for (i = 0; i < G_N_ELEMENTS(signalTable); i++) {
+		if (jaw_util_is_signal_hooked(signalTable[i].signal_id)) {
+			mask |= 1 << i;
+		}
+	}
+
+	// ATK turns these notifications into property-change
+	if (jaw_util_is_signal_hooked(signalTable[Sig_Object_Property_Change_Accessible_Actions].signal_id)) {
+		mask |= (1 << Sig_Object_Property_Change_Accessible_Value)
+			| (1 << Sig_Object_Property_Change_Accessible_Description)
+			| (1 << Sig_Object_Property_Change_Accessible_Name);
+	}
+
+	// Children changes keep the wrapper tree in sync, always forward them
+	mask |= (1 << Sig_Object_Children_Changed_Add)
+		| (1 << Sig_Object_Children_Changed_Remove);
+
+	if (jaw_util_is_signal_hooked(stateChangeSignal)) {
+		mask |= INTEREST_STATE_CHANGE;
+	}
+
+	jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkWrapper");
+	jfieldID jfid = (*jniEnv)->GetStaticFieldID(jniEnv, classAtkWrapper, "interestMask", "I");
+	(*jniEnv)->SetStaticIntField(jniEnv, classAtkWrapper, jfid, mask);
+}
+
+static void
+emit_plain (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark);
+}
+
+static void
+emit_int (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			para->int_args[0]);
+}
+
+static void
+emit_int_int (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			para->int_args[0],
+			para->int_args[1]);
+}
+
+/*
+ * Queues one compacted children change behind the adds already waiting,
+ * a burst of children added without wrappers ends up as one refresh.
+ */
+static void
+queue_children_refresh (JNIEnv *jniEnv, AtkObject *atk_obj, gint index)
+{
+	gint key = ((JawImpl*)atk_obj)->hash_key;
+	jobject ac = JAW_OBJECT(atk_obj)->acc_context;
+
+	if (lazyRefreshKeys == NULL) {
+		lazyRefreshKeys = g_hash_table_new(NULL, NULL);
+	}
+
+	if (g_hash_table_lookup(lazyRefreshKeys, GINT_TO_POINTER(key)) != NULL) {
+		return;
+	}
+	g_hash_table_insert(lazyRefreshKeys, GINT_TO_POINTER(key), atk_obj);
+
+	CallbackPara *para = take_callback_para(jniEnv, ac, key);
+	if (para->impl == NULL) {
+		para->global_ac = (*jniEnv)->NewGlobalRef(jniEnv, ac);
+	}
+	para->signal_id = Sig_Object_Children_Changed_Compacted;
+	para->int_args[0] = index;
+	para->int_args[1] = 0;
+
+	post_signal_para(para);
+}
+
+static void
+emit_child_added (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	JawImpl *child_impl;
+
+	if (lazy_children) {
+		// Without a wrapper the child is not announced by its index, which
+		// may be stale by the time the AT asks for it. The parent is told
+		// to read its children again instead.
+		child_impl = jaw_impl_find_instance_by_key(jniEnv, para->child_ac, para->child_key);
+		if (!child_impl) {
+			n_children_deferred++;
+			queue_children_refresh(jniEnv, atk_obj, para->int_args[0]);
+			return;
+		}
+	} else {
+		child_impl = jaw_impl_get_instance_by_key(jniEnv, para->child_ac, para->child_key);
+		if (!child_impl) {
+			return;
+		}
+	}
+
+	n_children_wrapped++;
+
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			para->int_args[0],
+			child_impl);
+}
+
+static void
+emit_child_removed (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	JawImpl *child_impl = jaw_impl_find_instance_by_key(jniEnv, para->child_ac, para->child_key);
+	if (!child_impl) {
+		return;
+	}
+
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			para->int_args[0],
+			child_impl);
+	g_object_unref(G_OBJECT(atk_obj));
+}
+
+static void
+emit_active_descendant (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	JawImpl *child_impl = jaw_impl_get_instance_by_key(jniEnv, para->child_ac, para->child_key);
+	if (!child_impl) {
+		return;
+	}
+
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			child_impl);
+}
+
+static void
+emit_actions (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	AtkPropertyValues values = { NULL };
+	g_value_init(&values.old_value, G_TYPE_INT);
+	g_value_set_int(&values.old_value, para->int_args[0]);
+	g_value_init(&values.new_value, G_TYPE_INT);
+	g_value_set_int(&values.new_value, para->int_args[1]);
+	values.property_name = info->detail;
+
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			&values);
+}
+
+static void
+emit_property_change (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	g_signal_emit(atk_obj, info->signal_id, info->detail_quark,
+			NULL);
+}
+
+static void
+emit_notify (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	g_object_notify_by_pspec(G_OBJECT(atk_obj), info->pspec);
+}
+
+static void
+emit_compacted (JNIEnv *jniEnv, AtkObject *atk_obj, const SignalInfo *info, CallbackPara *para)
+{
+	const SignalInfo *add_info = &signalTable[Sig_Object_Children_Changed_Add];
+
+	// One children change stands in for the batch, so ATs that cache
+	// children drop the parent's list. The child is left out, the bridge
+	// looks it up by index when it needs it.
+	g_signal_emit(atk_obj, add_info->signal_id, add_info->detail_quark,
+			para->int_args[0],
+			NULL);
+
+	if (ATK_IS_TABLE(atk_obj)) {
+		emit_plain(jniEnv, atk_obj, &signalTable[Sig_Table_Model_Changed], para);
+	}
+}
+
 static gboolean
 focus_notify_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_get_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_get_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
 		return FALSE;
 	}
 
+	// The snapshot still has the states from before the focus moved
+	jaw_snapshot_invalidate(JAW_OBJECT(jaw_impl), para->key);
+
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
 	atk_focus_tracker_notify(atk_obj);
 
@@ -279,22 +884,22 @@ focus_notify_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_focusNotify(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jlong jWhen) {
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_FOCUS, jWhen);
 
-	g_idle_add(focus_notify_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, focus_notify_handler, para);
 }
 
 static gboolean
 window_open_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 	gboolean is_toplevel = para->is_toplevel;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_get_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_get_instance(jniEnv, para);
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
 
 	if (!g_strcmp0(atk_role_get_name(atk_object_get_role(atk_obj)), "redundant object")) {
@@ -310,11 +915,14 @@ window_open_handler (gpointer p)
 	if (is_toplevel) {
 		gint n = jaw_toplevel_add_window(JAW_TOPLEVEL(atk_get_root()), atk_obj);
 		
-		g_object_notify(G_OBJECT(atk_get_root()), "accessible-name");
+		g_object_notify_by_pspec(G_OBJECT(atk_get_root()),
+				signalTable[Sig_Object_Property_Change_Accessible_Name].pspec);
 		
-		g_signal_emit_by_name(ATK_OBJECT(atk_get_root()),
-				"children-changed::add", n, atk_obj, NULL);
-		g_signal_emit(atk_obj, g_signal_lookup("create", JAW_TYPE_OBJECT), 0);
+		g_signal_emit(ATK_OBJECT(atk_get_root()),
+				signalTable[Sig_Object_Children_Changed_Add].signal_id,
+				signalTable[Sig_Object_Children_Changed_Add].detail_quark,
+				n, atk_obj);
+		g_signal_emit(atk_obj, windowSignals[Win_Create], 0);
 	}
 
 	free_callback_para(para);
@@ -323,24 +931,24 @@ window_open_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowOpen(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jboolean jIsToplevel) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jboolean jIsToplevel, jlong jWhen) {
 	
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_OPEN, jWhen);
 	para->is_toplevel = (jIsToplevel == JNI_TRUE) ? TRUE : FALSE;
 
-	g_idle_add(window_open_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_open_handler, para);
 }
 
 static gboolean
 window_close_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 	gboolean is_toplevel = para->is_toplevel;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -362,11 +970,14 @@ window_close_handler (gpointer p)
 	if (is_toplevel) {
 		gint n = jaw_toplevel_remove_window(JAW_TOPLEVEL(atk_get_root()), atk_obj);
 		
-		g_object_notify(G_OBJECT(atk_get_root()), "accessible-name");
-
-		g_signal_emit_by_name(ATK_OBJECT(atk_get_root()),
-				"children-changed::remove", n, atk_obj, NULL);
-		g_signal_emit(atk_obj, g_signal_lookup("destroy", JAW_TYPE_OBJECT), 0);
+		g_object_notify_by_pspec(G_OBJECT(atk_get_root()),
+				signalTable[Sig_Object_Property_Change_Accessible_Name].pspec);
+
+		g_signal_emit(ATK_OBJECT(atk_get_root()),
+				signalTable[Sig_Object_Children_Changed_Remove].signal_id,
+				signalTable[Sig_Object_Children_Changed_Remove].detail_quark,
+				n, atk_obj);
+		g_signal_emit(atk_obj, windowSignals[Win_Destroy], 0);
 	}
 
 	free_callback_para(para);
@@ -375,23 +986,23 @@ window_close_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowClose(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jboolean jIsToplevel) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jboolean jIsToplevel, jlong jWhen) {
 	
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_CLOSE, jWhen);
 	para->is_toplevel = (jIsToplevel == JNI_TRUE) ? TRUE : FALSE;
 
-	g_idle_add(window_close_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_close_handler, para);
 }
 
 static gboolean
 window_minimize_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -399,7 +1010,7 @@ window_minimize_handler (gpointer p)
 	}
 
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
-	g_signal_emit(atk_obj, g_signal_lookup("minimize", JAW_TYPE_OBJECT), 0);
+	g_signal_emit(atk_obj, windowSignals[Win_Minimize], 0);
 
 	free_callback_para(para);
 
@@ -407,21 +1018,21 @@ window_minimize_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowMinimize(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jlong jWhen) {
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_MINIMIZE, jWhen);
 
-	g_idle_add(window_minimize_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_minimize_handler, para);
 }
 
 static gboolean
 window_maximize_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -429,7 +1040,7 @@ window_maximize_handler (gpointer p)
 	}
 
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
-	g_signal_emit(atk_obj, g_signal_lookup("maximize", JAW_TYPE_OBJECT), 0);
+	g_signal_emit(atk_obj, windowSignals[Win_Maximize], 0);
 
 	free_callback_para(para);
 
@@ -437,22 +1048,22 @@ window_maximize_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowMaximize(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jlong jWhen) {
 
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_MAXIMIZE, jWhen);
 
-	g_idle_add(window_maximize_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_maximize_handler, para);
 }
 
 static gboolean
 window_restore_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -460,7 +1071,7 @@ window_restore_handler (gpointer p)
 	}
 
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
-	g_signal_emit(atk_obj, g_signal_lookup("restore", JAW_TYPE_OBJECT), 0);
+	g_signal_emit(atk_obj, windowSignals[Win_Restore], 0);
 
 	free_callback_para(para);
 
@@ -468,22 +1079,22 @@ window_restore_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowRestore(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jlong jWhen) {
 
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_RESTORE, jWhen);
 
-	g_idle_add(window_restore_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_restore_handler, para);
 }
 
 static gboolean
 window_activate_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -491,7 +1102,7 @@ window_activate_handler (gpointer p)
 	}
 
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
-	g_signal_emit(atk_obj, g_signal_lookup("activate", JAW_TYPE_OBJECT), 0);
+	g_signal_emit(atk_obj, windowSignals[Win_Activate], 0);
 
 	free_callback_para(para);
 
@@ -499,22 +1110,22 @@ window_activate_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowActivate(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jlong jWhen) {
 
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_ACTIVATE, jWhen);
 
-	g_idle_add(window_activate_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_activate_handler, para);
 }
 
 static gboolean
 window_deactivate_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -522,7 +1133,7 @@ window_deactivate_handler (gpointer p)
 	}
 
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
-	g_signal_emit(atk_obj, g_signal_lookup("deactivate", JAW_TYPE_OBJECT), 0);
+	g_signal_emit(atk_obj, windowSignals[Win_Deactivate], 0);
 
 	free_callback_para(para);
 
@@ -530,22 +1141,21 @@ window_deactivate_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowDeactivate(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jlong jWhen) {
 
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_WINDOW_DEACTIVATE, jWhen);
 
-	g_idle_add(window_deactivate_handler, para);
+	post_callback_para(JAW_EVENT_LANE_FOCUS, window_deactivate_handler, para);
 }
 
 static gboolean
 window_state_change_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_get_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_get_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
@@ -553,7 +1163,7 @@ window_state_change_handler (gpointer p)
 	}
 
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
-	g_signal_emit(atk_obj, g_signal_lookup("state-change", JAW_TYPE_OBJECT), 0);
+	g_signal_emit(atk_obj, windowSignals[Win_State_Change], 0);
 
 	free_callback_para(para);
 
@@ -561,12 +1171,12 @@ window_state_change_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_windowStateChange(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey) {
 
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
 
 	//g_idle_add(window_state_change_handler, para);
+	free_callback_para(para);
 }
 
 static gchar
@@ -593,14 +1203,6 @@ get_float_value (JNIEnv *jniEnv, jobject o)
 	return (gfloat)(*jniEnv)->CallFloatMethod(jniEnv, o, jmid);
 }
 
-static gint
-get_int_value (JNIEnv *jniEnv, jobject o)
-{
-	jclass classInteger = (*jniEnv)->FindClass(jniEnv, "java/lang/Integer");
-	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classInteger, "intValue", "()I");
-	return (gint)(*jniEnv)->CallIntMethod(jniEnv, o, jmid);
-}
-
 static gint64
 get_int64_value (JNIEnv *jniEnv, jobject o)
 {
@@ -609,245 +1211,104 @@ get_int64_value (JNIEnv *jniEnv, jobject o)
 	return (gint64)(*jniEnv)->CallLongMethod(jniEnv, o, jmid);
 }
 
+static JawEventLane
+get_signal_lane (SignalType signal_id)
+{
+	switch (signal_id) {
+		case Sig_Object_Active_Descendant_Changed:
+			return JAW_EVENT_LANE_FOCUS;
+		case Sig_Text_Caret_Moved:
+		case Sig_Object_Selection_Changed:
+		case Sig_Object_Property_Change_Accessible_Actions:
+		case Sig_Object_Property_Change_Accessible_Value:
+		case Sig_Object_Property_Change_Accessible_Description:
+		case Sig_Object_Property_Change_Accessible_Name:
+			return JAW_EVENT_LANE_STATE;
+		default:
+			return JAW_EVENT_LANE_BULK;
+	}
+}
+
+// Events that only tell "something changed on this object" and can be merged
+static guint
+get_signal_compact_kind (SignalType signal_id)
+{
+	switch (signal_id) {
+		case Sig_Object_Children_Changed_Add:
+		case Sig_Object_Children_Changed_Remove:
+		case Sig_Object_Children_Changed_Compacted:
+			return Sig_Object_Children_Changed_Compacted;
+		case Sig_Object_Selection_Changed:
+		case Sig_Object_Visible_Data_Changed:
+		case Sig_Object_Property_Change_Accessible_Value:
+		case Sig_Object_Property_Change_Accessible_Description:
+		case Sig_Object_Property_Change_Accessible_Name:
+		case Sig_Object_Property_Change_Accessible_Table_Caption:
+		case Sig_Object_Property_Change_Accessible_Table_Summary:
+		case Sig_Table_Model_Changed:
+			return signal_id;
+		default:
+			return 0;
+	}
+}
+
+static void
+compact_children_changed (gpointer p)
+{
+	CallbackPara *para = (CallbackPara*)p;
+	para->signal_id = Sig_Object_Children_Changed_Compacted;
+}
+
 static gboolean
 signal_emit_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
-	jobjectArray args = para->args;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
+
+	if (para->signal_id == Sig_Object_Children_Changed_Compacted && lazyRefreshKeys != NULL) {
+		g_hash_table_remove(lazyRefreshKeys, GINT_TO_POINTER(para->key));
+	}
 	
 	if (jaw_impl == NULL) {
+		// A snapshot node still waiting for its wrapper is stale now
+		jaw_snapshot_invalidate(NULL, para->key);
 		free_callback_para(para);
 		return FALSE;
 	}
 
-	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
+	jaw_snapshot_invalidate(JAW_OBJECT(jaw_impl), para->key);
 
 	switch (para->signal_id) {
-		case Sig_Text_Caret_Moved:
-		{
-			gint cursor_pos = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-			g_signal_emit_by_name(atk_obj, "text_caret_moved", cursor_pos);
-			break;
-		}
-		case Sig_Text_Property_Changed_Insert:
-		{
-			gint insert_position = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-			gint insert_length = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
-			g_signal_emit_by_name(atk_obj,
-					"text_changed::insert",
-					insert_position,
-					insert_length);
-			break;
-		}
-		case Sig_Text_Property_Changed_Delete:
-		{
-			gint delete_position = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-			gint delete_length = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
-			g_signal_emit_by_name(atk_obj,
-					"text_changed::delete",
-					delete_position,
-					delete_length);
-			break;
-		}
 		case Sig_Object_Children_Changed_Add:
-		{
-			gint child_index = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-			jobject child_ac = (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1);
-			JawImpl *child_impl = jaw_impl_get_instance(jniEnv, child_ac);
-			if (!child_impl) {
-				break;
-			}
-
-			g_signal_emit_by_name(atk_obj,
-					"children_changed::add",
-					child_index,
-					child_impl);
-			break;
-		}
 		case Sig_Object_Children_Changed_Remove:
-		{
-			gint child_index = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-			jobject child_ac = (*jniEnv)->GetObjectArrayElement(jniEnv, args, 1);
-			JawImpl *child_impl = jaw_impl_find_instance(jniEnv, child_ac);
-			if (!child_impl) {
-				break;
-			}
-
-			g_signal_emit_by_name(atk_obj,
-					"children_changed::remove",
-					child_index,
-					child_impl);
-			g_object_unref(G_OBJECT(atk_obj));
-			break;
-		}
-		case Sig_Object_Active_Descendant_Changed:
-		{
-			jobject child_ac = (*jniEnv)->GetObjectArrayElement(jniEnv, args, 0);
-			JawImpl *child_impl = jaw_impl_get_instance(jniEnv, child_ac);
-			if (!child_impl) {
-				break;
-			}
-
-			g_signal_emit_by_name(atk_obj,
-					"active_descendant_changed",
-					child_impl);
-			break;
-		}
-		case Sig_Object_Selection_Changed:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"selection_changed");
-			break;
-		}
+		case Sig_Object_Children_Changed_Compacted:
 		case Sig_Object_Visible_Data_Changed:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"visible_data_changed");
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Actions:
-		{
-			gint oldValue = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-			gint newValue = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 1));
-			AtkPropertyValues values = { NULL };
-			g_value_init(&values.old_value, G_TYPE_INT);
-			g_value_set_int(&values.old_value, oldValue);
-			g_value_init(&values.new_value, G_TYPE_INT);
-			g_value_set_int(&values.new_value, newValue);
-			values.property_name = "accessible-actions";
-
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-actions",
-					&values);
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Value:
-		{
-			g_object_notify(G_OBJECT(atk_obj), "accessible-value");
+		case Sig_Table_Model_Changed:
+			// Cached parents and indexes of the children may be stale now
+			jaw_object_children_changed(JAW_OBJECT(jaw_impl));
 			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Description:
-		{
-			g_object_notify(G_OBJECT(atk_obj), "accessible-description");
+		case Sig_Text_Property_Changed_Insert:
+		case Sig_Text_Property_Changed_Delete:
+			// Prefetched text is stale
+			jaw_object_content_changed(JAW_OBJECT(jaw_impl));
 			break;
-		}
 		case Sig_Object_Property_Change_Accessible_Name:
-		{
-			g_object_notify(G_OBJECT(atk_obj), "accessible-name");
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Hypertext_Offset:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-hypertext-offset",
-					NULL);
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Table_Caption:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-table-caption",
-					NULL);
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Table_Summary:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-table-summary",
-					NULL);
+			// The application is named after its first named window
+			jaw_toplevel_window_name_changed(JAW_TOPLEVEL(atk_get_root()),
+					ATK_OBJECT(jaw_impl));
 			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Table_Column_Header:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-table-column-header",
-					NULL);
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Table_Column_Description:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-table-column-description",
-					NULL);
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Table_Row_Header:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-table-row-header",
-					NULL);
-			break;
-		}
-		case Sig_Object_Property_Change_Accessible_Table_Row_Description:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"property_change::accessible-table-row-description",
-					NULL);
-			break;
-		}
-		case Sig_Table_Model_Changed:
-		{
-			g_signal_emit_by_name(atk_obj,
-					"model_changed");
+		default:
 			break;
-		}
-		case Sig_Text_Property_Changed:
-		{
-			JawObject * jaw_obj = JAW_OBJECT(atk_obj);
-
-			gint newValue = get_int_value(
-					jniEnv,
-					(*jniEnv)->GetObjectArrayElement(jniEnv, args, 0));
-
-			gint prevCount = (gint)g_hash_table_lookup(
-					jaw_obj->storedData,
-					"Previous_Count");
-			gint curCount = atk_text_get_character_count(
-					ATK_TEXT(jaw_obj));
-
-			g_hash_table_insert(
-					jaw_obj->storedData,
-					"Previous_Count",
-					(gpointer)curCount);
-
-			if (curCount > prevCount) {
-				g_signal_emit_by_name(atk_obj,
-						"text_changed::insert",
-						newValue,
-						curCount - prevCount);
-			} else if (curCount < prevCount) {
-				g_signal_emit_by_name(atk_obj,
-						"text_changed::delete",
-						newValue,
-						prevCount - curCount);
-			}
+	}
 
-			break;
+	if (para->signal_id < G_N_ELEMENTS(signalTable)) {
+		const SignalInfo *info = &signalTable[para->signal_id];
+		if (info->emit != NULL) {
+			info->emit(jniEnv, ATK_OBJECT(jaw_impl), info, para);
 		}
-		default:
-			break;
 	}
 
 	free_callback_para(para);
@@ -855,31 +1316,74 @@ signal_emit_handler (gpointer p)
 	return FALSE;
 }
 
-JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignal(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint id, jobjectArray args) {
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	jobjectArray global_args = (jobjectArray)(*jniEnv)->NewGlobalRef(jniEnv, args);
-	CallbackPara *para = alloc_callback_para(global_ac);
+static CallbackPara*
+alloc_signal_para (JNIEnv *jniEnv, jobject jAccContext, jint jKey, jint id, jlong jWhen)
+{
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, (guint)id, jWhen);
 	para->signal_id = (gint)id;
-	para->args = global_args;
+	para->int_args[0] = 0;
+	para->int_args[1] = 0;
 
-	g_idle_add(signal_emit_handler, para);
+	return para;
+}
+
+static void
+post_signal_para (CallbackPara *para)
+{
+	guint kind = get_signal_compact_kind(para->signal_id);
+
+	jaw_event_post_compactable(get_signal_lane(para->signal_id),
+			signal_emit_handler,
+			para,
+			(GDestroyNotify)free_callback_para,
+			para->key,
+			kind,
+			kind == Sig_Object_Children_Changed_Compacted ? compact_children_changed : NULL);
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignal(
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jint id, jlong jWhen) {
+	CallbackPara *para = alloc_signal_para(jniEnv, jAccContext, jKey, id, jWhen);
+
+	post_signal_para(para);
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignalII(
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jint id, jint arg1, jint arg2, jlong jWhen) {
+	CallbackPara *para = alloc_signal_para(jniEnv, jAccContext, jKey, id, jWhen);
+	para->int_args[0] = (gint)arg1;
+	para->int_args[1] = (gint)arg2;
+
+	post_signal_para(para);
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_emitSignalObj(
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jint id, jint index, jobject jChildContext, jint jChildKey, jlong jWhen) {
+	CallbackPara *para = alloc_signal_para(jniEnv, jAccContext, jKey, id, jWhen);
+	para->int_args[0] = (gint)index;
+	para->child_ac = (*jniEnv)->NewGlobalRef(jniEnv, jChildContext);
+	para->child_key = (gint)jChildKey;
+
+	post_signal_para(para);
 }
 
 static gboolean
 object_state_change_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
+	callback_para_dispatched(para);
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_get_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_get_instance(jniEnv, para);
 	
 	if (jaw_impl == NULL) {
 		free_callback_para(para);
 		return FALSE;
 	}
 
+	jaw_snapshot_invalidate(JAW_OBJECT(jaw_impl), para->key);
+
 	atk_object_notify_state_change(
 			ATK_OBJECT(jaw_impl),
 			para->atk_state,
@@ -891,9 +1395,9 @@ object_state_change_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_objectStateChange(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jobject state, jboolean value) {
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey, jobject state, jboolean value, jlong jWhen) {
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+	callback_para_set_trace(para, JAW_TRACE_STATE_CHANGE, jWhen);
 	AtkStateType state_type = jaw_util_get_atk_state_type_from_java_state( jniEnv, state );
 	para->atk_state = state_type;
 	if (value == JNI_TRUE) {
@@ -902,17 +1406,57 @@ JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_objectStateChange
 		para->state_value = FALSE;
 	}
 
-	g_idle_add(object_state_change_handler, para);
+	post_callback_para(JAW_EVENT_LANE_STATE, object_state_change_handler, para);
+}
+
+/*
+ * Turns a record from the event ring into the same event the JNI
+ * entry points above would have queued.
+ */
+static void
+consume_ring_record (JNIEnv *jniEnv, const JawRingRecord *record, guint slot)
+{
+	jobject ac = jaw_ring_get_slot(jniEnv, slot, 0);
+	CallbackPara *para = take_callback_para(jniEnv, ac, record->key);
+
+	if (para->impl == NULL) {
+		para->global_ac = (*jniEnv)->NewGlobalRef(jniEnv, ac);
+	}
+	(*jniEnv)->DeleteLocalRef(jniEnv, ac);
+
+	if (record->kind == JAW_RING_STATE_CHANGE) {
+		jobject state = jaw_ring_get_slot(jniEnv, slot, 1);
+		callback_para_set_trace(para, JAW_TRACE_STATE_CHANGE, record->when);
+		para->atk_state = jaw_util_get_atk_state_type_from_java_state(jniEnv, state);
+		para->state_value = record->arg1 ? TRUE : FALSE;
+		(*jniEnv)->DeleteLocalRef(jniEnv, state);
+
+		post_callback_para(JAW_EVENT_LANE_STATE, object_state_change_handler, para);
+		return;
+	}
+
+	callback_para_set_trace(para, (guint)record->id, record->when);
+	para->signal_id = record->id;
+	para->int_args[0] = record->arg1;
+	para->int_args[1] = record->arg2;
+
+	if (record->kind == JAW_RING_SIGNAL_OBJ) {
+		jobject child = jaw_ring_get_slot(jniEnv, slot, 1);
+		para->child_ac = (*jniEnv)->NewGlobalRef(jniEnv, child);
+		para->child_key = record->extra_key;
+		(*jniEnv)->DeleteLocalRef(jniEnv, child);
+	}
+
+	post_signal_para(para);
 }
 
 static gboolean
 component_added_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_get_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_get_instance(jniEnv, para);
 	
 	AtkObject* atk_obj = ATK_OBJECT(jaw_impl);
 	if (atk_object_get_role(atk_obj) == ATK_ROLE_TOOL_TIP) {
@@ -925,21 +1469,19 @@ component_added_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_componentAdded(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey) {
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
 
-	g_idle_add(component_added_handler, para);
+	post_callback_para(JAW_EVENT_LANE_STATE, component_added_handler, para);
 }
 
 static gboolean
 component_removed_handler (gpointer p)
 {
 	CallbackPara *para = (CallbackPara*)p;
-	jobject global_ac = para->global_ac;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	JawImpl* jaw_impl = jaw_impl_find_instance(jniEnv, global_ac);
+	JawImpl* jaw_impl = callback_para_find_instance(jniEnv, para);
 
 	if (!jaw_impl) {
 		free_callback_para(para);
@@ -957,11 +1499,28 @@ component_removed_handler (gpointer p)
 }
 
 JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkWrapper_componentRemoved(
-		JNIEnv *jniEnv, jclass jClass, jobject jAccContext) {
-	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, jAccContext);
-	CallbackPara *para = alloc_callback_para(global_ac);
+		JNIEnv *jniEnv, jclass jClass, jobject jAccContext, jint jKey) {
+	CallbackPara *para = alloc_callback_para(jniEnv, jAccContext, jKey);
+
+	post_callback_para(JAW_EVENT_LANE_STATE, component_removed_handler, para);
+}
 
-	g_idle_add(component_removed_handler, para);
+// Keyvals sharing a slot only make the count lower than it should be
+static void
+count_key_string (JNIEnv *jniEnv, guint keyval, jstring jstr)
+{
+	jweak *slot = &keyStrings[keyval % KEY_STRING_SLOTS];
+
+	n_key_events++;
+	if (*slot != NULL && (*jniEnv)->IsSameObject(jniEnv, *slot, jstr)) {
+		n_key_strings_shared++;
+		return;
+	}
+
+	if (*slot != NULL) {
+		(*jniEnv)->DeleteWeakGlobalRef(jniEnv, *slot);
+	}
+	*slot = (*jniEnv)->NewWeakGlobalRef(jniEnv, jstr);
 }
 
 static gboolean
@@ -1025,6 +1584,9 @@ key_dispatch_handler (gpointer p)
 	jstring jstr = (jstring)(*jniEnv)->GetObjectField(jniEnv, jAtkKeyEvent, jfidString);
 	event->length = (gint)(*jniEnv)->GetStringLength(jniEnv, jstr);
 	event->string = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, jstr, NULL);
+	if (jaw_debug) {
+		count_key_string(jniEnv, event->keyval, jstr);
+	}
 
 	// keycode
 	jfieldID jfidKeycode = (*jniEnv)->GetFieldID(jniEnv, classAtkKeyEvent, "keycode", "I");
@@ -1052,14 +1614,36 @@ key_dispatch_handler (gpointer p)
 	return FALSE;
 }
 
+JNIEXPORT jlongArray JNICALL Java_org_GNOME_Accessibility_AtkWrapper_getLatencyHistogram(
+		JNIEnv *jniEnv, jclass jClass, jint type, jint stage) {
+	guint n_buckets;
+	guint64 *buckets = jaw_trace_get_histogram((guint)type, (JawTraceStage)stage, &n_buckets);
+
+	jlongArray jBuckets = (*jniEnv)->NewLongArray(jniEnv, n_buckets * 2);
+	if (jBuckets != NULL && n_buckets > 0) {
+		(*jniEnv)->SetLongArrayRegion(jniEnv, jBuckets, 0, n_buckets * 2, (jlong*)buckets);
+	}
+
+	g_free(buckets);
+
+	return jBuckets;
+}
+
 JNIEXPORT jboolean JNICALL Java_org_GNOME_Accessibility_AtkWrapper_dispatchKeyEvent(
 		JNIEnv *jniEnv, jclass jClass, jobject jAtkKeyEvent) {
 	jboolean key_consumed;
+
+	// No key listener can be registered before the bridge is loaded
+	if (!jaw_event_queue_is_ready()) {
+		return JNI_FALSE;
+	}
+
 	jobject global_key_event = (*jniEnv)->NewGlobalRef(jniEnv, jAtkKeyEvent);
 
 	g_mutex_lock(key_dispatch_mutex);
 	
-	g_idle_add(key_dispatch_handler, (gpointer)global_key_event);
+	jaw_event_post(JAW_EVENT_LANE_FOCUS, key_dispatch_handler,
+			(gpointer)global_key_event, NULL);
 
 	while (key_dispatch_result == KEY_DISPATCH_NOT_DISPATCHED) {
 		g_cond_wait(key_dispatch_cond, key_dispatch_mutex);
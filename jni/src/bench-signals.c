@@ -0,0 +1,169 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdlib.h>
+#include <glib.h>
+#include <atk/atk.h>
+
+/*
+ * Signal storm: emits the signals signal_emit_handler sends most, once
+ * through g_signal_emit_by_name as it used to and once through ids and
+ * quarks resolved up front as the signal table does now. An emission
+ * hook stands in for the bridge, so neither path can skip emission.
+ *
+ *   make bench-signals && ./bench-signals [emissions]
+ */
+
+typedef struct _BenchSignal {
+	const gchar *detailed_name;
+	const gchar *name;
+	const gchar *detail;
+	guint signal_id;
+	GQuark detail_quark;
+} BenchSignal;
+
+static BenchSignal signals[] = {
+	{ "children_changed::add", "children_changed", "add", 0, 0 },
+	{ "property_change::accessible-name", "property_change", "accessible-name", 0, 0 },
+	{ "property_change::accessible-table-caption", "property_change", "accessible-table-caption", 0, 0 },
+	{ "state-change", "state-change", NULL, 0, 0 },
+	{ "visible_data_changed", "visible_data_changed", NULL, 0, 0 },
+};
+
+enum {
+	Bench_Children_Changed,
+	Bench_Property_Change_Name,
+	Bench_Property_Change_Caption,
+	Bench_State_Change,
+	Bench_Visible_Data_Changed
+};
+
+static guint64 n_hooked = 0;
+
+static gboolean
+bench_hook (GSignalInvocationHint *hint,
+		guint n_values,
+		const GValue *values,
+		gpointer data)
+{
+	n_hooked++;
+	return TRUE;
+}
+
+static void
+emit_by_name (AtkObject *atk_obj, guint i)
+{
+	const gchar *name = signals[i].detailed_name;
+
+	switch (i) {
+		case Bench_Children_Changed:
+			g_signal_emit_by_name(atk_obj, name, 0, NULL);
+			break;
+		case Bench_State_Change:
+			g_signal_emit_by_name(atk_obj, name, "focused", TRUE);
+			break;
+		case Bench_Property_Change_Name:
+		case Bench_Property_Change_Caption:
+		{
+			AtkPropertyValues values = { NULL };
+			values.property_name = signals[i].detail;
+			g_signal_emit_by_name(atk_obj, name, &values);
+			break;
+		}
+		default:
+			g_signal_emit_by_name(atk_obj, name);
+			break;
+	}
+}
+
+static void
+emit_by_id (AtkObject *atk_obj, guint i)
+{
+	const BenchSignal *info = &signals[i];
+
+	switch (i) {
+		case Bench_Children_Changed:
+			g_signal_emit(atk_obj, info->signal_id, info->detail_quark, 0, NULL);
+			break;
+		case Bench_State_Change:
+			g_signal_emit(atk_obj, info->signal_id, info->detail_quark, "focused", TRUE);
+			break;
+		case Bench_Property_Change_Name:
+		case Bench_Property_Change_Caption:
+		{
+			AtkPropertyValues values = { NULL };
+			values.property_name = info->detail;
+			g_signal_emit(atk_obj, info->signal_id, info->detail_quark, &values);
+			break;
+		}
+		default:
+			g_signal_emit(atk_obj, info->signal_id, info->detail_quark);
+			break;
+	}
+}
+
+static gdouble
+run (AtkObject *atk_obj, void (*emit)(AtkObject*, guint), guint64 n_emissions)
+{
+	guint64 i;
+	gint64 start = g_get_monotonic_time();
+
+	for (i = 0; i < n_emissions; i++) {
+		emit(atk_obj, i % G_N_ELEMENTS(signals));
+	}
+
+	return (gdouble)(g_get_monotonic_time() - start) * 1000.0 / n_emissions;
+}
+
+int
+main (int argc, char **argv)
+{
+	guint64 n_emissions = argc > 1 ? g_ascii_strtoull(argv[1], NULL, 10) : 1000000;
+	AtkObject *atk_obj;
+	guint i;
+
+	if (n_emissions == 0) {
+		g_printerr("usage: %s [emissions]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	g_type_init();
+	atk_obj = ATK_OBJECT(g_object_new(ATK_TYPE_OBJECT, NULL));
+
+	for (i = 0; i < G_N_ELEMENTS(signals); i++) {
+		signals[i].signal_id = g_signal_lookup(signals[i].name, ATK_TYPE_OBJECT);
+		signals[i].detail_quark = signals[i].detail ?
+			g_quark_from_static_string(signals[i].detail) : 0;
+		g_signal_add_emission_hook(signals[i].signal_id, 0, bench_hook, NULL, NULL);
+	}
+
+	// Warm up type and quark caches for both paths
+	run(atk_obj, emit_by_name, G_N_ELEMENTS(signals) * 1000);
+	run(atk_obj, emit_by_id, G_N_ELEMENTS(signals) * 1000);
+
+	g_print("%" G_GUINT64_FORMAT " emissions\n", n_emissions);
+	g_print("g_signal_emit_by_name: %.1f ns/emission\n",
+			run(atk_obj, emit_by_name, n_emissions));
+	g_print("g_signal_emit:         %.1f ns/emission\n",
+			run(atk_obj, emit_by_id, n_emissions));
+
+	g_object_unref(atk_obj);
+
+	return n_hooked > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -40,12 +40,9 @@ static G_CONST_RETURN gchar*	jaw_action_get_keybinding		(AtkAction	*action,
 
 typedef struct _ActionData {
 	jobject atk_action;
-	gchar* action_name;
-	jstring jstrActionName;
-	gchar* action_description;
-	jstring jstrActionDescription;
-	gchar* action_keybinding;
-	jstring jstrActionKeybinding;
+	JawStringSlot action_name;
+	JawStringSlot action_description;
+	JawStringSlot action_keybinding;
 } ActionData;
 
 void
@@ -81,26 +78,9 @@ jaw_action_data_finalize (gpointer p)
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
 	if (data && data->atk_action) {
-		if (data->action_name != NULL) {
-			(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrActionName, data->action_name);
-			(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrActionName);
-			data->jstrActionName = NULL;
-			data->action_name = NULL;
-		}
-
-		if (data->action_description != NULL) {
-			(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrActionDescription, data->action_description);
-			(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrActionDescription);
-			data->jstrActionDescription = NULL;
-			data->action_description = NULL;
-		}
-
-		if (data->action_keybinding != NULL) {
-			(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrActionKeybinding, data->action_keybinding);
-			(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrActionKeybinding);
-			data->jstrActionKeybinding = NULL;
-			data->action_keybinding = NULL;
-		}
+		jaw_string_slot_clear(jniEnv, &data->action_name);
+		jaw_string_slot_clear(jniEnv, &data->action_description);
+		jaw_string_slot_clear(jniEnv, &data->action_keybinding);
 
 		(*jniEnv)->DeleteGlobalRef(jniEnv, data->atk_action);
 		data->atk_action = NULL;
@@ -154,15 +134,7 @@ jaw_action_get_description (AtkAction *action,
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkAction, "get_description", "(I)Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_action, jmid, (jint)i);
 
-	if (data->action_description != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrActionDescription, data->action_description);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrActionDescription);
-	}
-	
-	data->jstrActionDescription = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-	data->action_description = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, data->jstrActionDescription, NULL);
-
-	return data->action_description;
+	return jaw_string_slot_set(jniEnv, &data->action_description, jstr);
 }
 
 static G_CONST_RETURN gchar*
@@ -178,15 +150,7 @@ jaw_action_get_name (AtkAction *action,
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkAction, "get_name", "(I)Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_action, jmid, (jint)i);
 
-	if (data->action_name != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrActionName, data->action_name);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrActionName);
-	}
-	
-	data->jstrActionName = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-	data->action_name = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, data->jstrActionName, NULL);
-
-	return data->action_name;
+	return jaw_string_slot_set(jniEnv, &data->action_name, jstr);
 }
 
 static G_CONST_RETURN gchar*
@@ -202,14 +166,6 @@ jaw_action_get_keybinding (AtkAction *action,
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkAction, "get_keybinding", "(I)Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_action, jmid, (jint)i);
 
-	if (data->action_keybinding != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrActionKeybinding, data->action_keybinding);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrActionKeybinding);
-	}
-	
-	data->jstrActionKeybinding = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-	data->action_keybinding = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, data->jstrActionKeybinding, NULL);
-
-	return data->action_keybinding;
+	return jaw_string_slot_set(jniEnv, &data->action_keybinding, jstr);
 }
 
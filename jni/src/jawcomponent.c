@@ -21,6 +21,7 @@
 #include <glib.h>
 #include "jawimpl.h"
 #include "jawutil.h"
+#include "jawsnapshot.h"
 
 extern void	jaw_component_interface_init	(AtkComponentIface*);
 extern gpointer	jaw_component_data_init		(jobject);
@@ -166,6 +167,16 @@ jaw_component_get_extents (AtkComponent *component,
 			gint *width, gint *height,
 			AtkCoordType coord_type)
 {
+	JawSnapshotNode *node = jaw_snapshot_get(JAW_OBJECT(component));
+	if (node != NULL && node->has_bounds && coord_type == ATK_XY_SCREEN
+			&& x != NULL && y != NULL && width != NULL && height != NULL) {
+		(*x) = node->x;
+		(*y) = node->y;
+		(*width) = node->width;
+		(*height) = node->height;
+		return;
+	}
+
 	jaw_component_get_position (component, x, y, coord_type);
 	jaw_component_get_size (component, width, height);
 }
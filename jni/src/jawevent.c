@@ -0,0 +1,724 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include "jawevent.h"
+
+/*
+ * All wrapper work runs on a private main context, so it does not
+ * compete with idle work of a GTK look and feel on the default
+ * context. A bridge that can be told which context to use serves AT
+ * requests from the private one as well. An older bridge only uses the
+ * default context, then the loop thread runs that one and dispatches
+ * the private context from a source attached to it, see
+ * jaw_event_queue_attach.
+ *
+ * Events are queued in priority lanes and handed out by a single
+ * dispatcher source, so a focus change does not wait behind a burst
+ * of children or text events. Events of one object still go out in
+ * the order they were posted: when one is posted to a higher lane, the
+ * ones of the same object waiting in lower lanes move up ahead of it.
+ * Before the ATK bridge has registered its listeners the lanes only
+ * fill up, and are drained once it is ready.
+ *
+ * The queue is bounded. When it is full, events of the same kind for
+ * the same object are first collapsed into one, then the oldest bulk
+ * and state events are dropped. Focus lane events and children changes
+ * are not dropped, the latter are only collapsed. When that does not
+ * make room the queue grows, and the next scan waits until it grew by
+ * another quarter of its capacity.
+ *
+ * It grows up to JAW_EVENT_QUEUE_HARD_FACTOR times its capacity and no
+ * further. At that hard limit a new event is merged into a waiting one
+ * of the same kind for the same object if there is one. Otherwise a
+ * focus lane event takes the place of the oldest waiting event, bulk
+ * and state lane events first, and any other event is refused. Every
+ * lost event bumps the drop generation like a drop does.
+ */
+
+typedef struct _JawPendingEvent {
+	GSourceFunc func;
+	gpointer data;
+	GDestroyNotify destroy;
+	gint64 enqueue_time;
+	guint64 seq;
+	gint key;
+	guint kind;
+	JawEventCompactFunc compact;
+	gboolean compacted;
+} JawPendingEvent;
+
+typedef struct _JawContextSource {
+	GSource source;
+	GMainContext *context;
+} JawContextSource;
+
+static GMainContext *eventContext = NULL;
+static GMainContext *outerContext = NULL;
+static GMutex *eventQueueMutex = NULL;
+static GQueue *laneQueues[JAW_EVENT_N_LANES] = { NULL, };
+// Number of waiting events per object key, for each lane
+static GHashTable *laneKeys[JAW_EVENT_N_LANES] = { NULL, };
+static guint64 nextSeq = 0;
+static JawEventLaneStats laneStats[JAW_EVENT_N_LANES];
+static JawEventQueueStats queueStats;
+static guint queueCapacity = JAW_EVENT_QUEUE_SIZE;
+static guint pressureLimit = JAW_EVENT_QUEUE_SIZE;
+static guint hardLimit = JAW_EVENT_QUEUE_SIZE * JAW_EVENT_QUEUE_HARD_FACTOR;
+static guint nPendingEvents = 0;
+static gint dropGeneration = 0;
+static gboolean eventQueueReady = FALSE;
+static gboolean dispatchScheduled = FALSE;
+
+static const gchar *laneNames[JAW_EVENT_N_LANES] = {
+	"focus",
+	"state",
+	"bulk"
+};
+
+void
+jaw_event_queue_init (void)
+{
+	gint lane;
+
+	if (eventQueueMutex == NULL) {
+		eventQueueMutex = g_mutex_new();
+	}
+
+	g_mutex_lock(eventQueueMutex);
+	const gchar *size_env = g_getenv("JAW_EVENT_QUEUE_SIZE");
+	if (size_env != NULL) {
+		guint64 size = g_ascii_strtoull(size_env, NULL, 10);
+		queueCapacity = (guint)CLAMP(size, JAW_EVENT_QUEUE_MIN_SIZE, G_MAXINT);
+	}
+	hardLimit = (guint)MIN((guint64)queueCapacity * JAW_EVENT_QUEUE_HARD_FACTOR, G_MAXINT);
+	queueStats.capacity = queueCapacity;
+	queueStats.hard_limit = hardLimit;
+	pressureLimit = queueCapacity;
+
+	if (eventContext == NULL) {
+		eventContext = g_main_context_new();
+	}
+
+	for (lane = 0; lane < JAW_EVENT_N_LANES; lane++) {
+		if (laneQueues[lane] == NULL) {
+			laneQueues[lane] = g_queue_new();
+			laneKeys[lane] = g_hash_table_new(NULL, NULL);
+		}
+	}
+	g_mutex_unlock(eventQueueMutex);
+}
+
+GMainContext*
+jaw_event_queue_get_context (void)
+{
+	return eventContext;
+}
+
+guint
+jaw_event_idle_add (GSourceFunc func, gpointer data)
+{
+	guint id;
+	GSource *source = g_idle_source_new();
+
+	g_source_set_callback(source, func, data, NULL);
+	id = g_source_attach(source, eventContext);
+	g_source_unref(source);
+
+	// The loop thread sleeps in the outer context's poll
+	if (outerContext != NULL) {
+		g_main_context_wakeup(outerContext);
+	}
+
+	return id;
+}
+
+// Only idle sources live on the private context, it has work whenever
+// one of them is attached
+static gboolean
+context_source_prepare (GSource *source, gint *timeout)
+{
+	*timeout = -1;
+	return g_main_context_pending(((JawContextSource*)source)->context);
+}
+
+static gboolean
+context_source_check (GSource *source)
+{
+	return g_main_context_pending(((JawContextSource*)source)->context);
+}
+
+static gboolean
+context_source_dispatch (GSource *source, GSourceFunc callback, gpointer data)
+{
+	// One iteration, then the outer context gets its turn again
+	g_main_context_iteration(((JawContextSource*)source)->context, FALSE);
+	return TRUE;
+}
+
+static GSourceFuncs contextSourceFuncs = {
+	context_source_prepare,
+	context_source_check,
+	context_source_dispatch,
+	NULL
+};
+
+void
+jaw_event_queue_attach (GMainContext *context)
+{
+	GSource *source = g_source_new(&contextSourceFuncs, sizeof(JawContextSource));
+	((JawContextSource*)source)->context = eventContext;
+
+	outerContext = g_main_context_ref(context);
+	g_source_attach(source, context);
+	g_source_unref(source);
+}
+
+static void
+lane_push (gint lane, JawPendingEvent *event)
+{
+	g_queue_push_tail(laneQueues[lane], event);
+
+	if (event->key != 0) {
+		gpointer key = GINT_TO_POINTER(event->key);
+		gint count = GPOINTER_TO_INT(g_hash_table_lookup(laneKeys[lane], key));
+		g_hash_table_insert(laneKeys[lane], key, GINT_TO_POINTER(count + 1));
+	}
+}
+
+// Bookkeeping for an event that left its lane
+static void
+lane_forget (gint lane, JawPendingEvent *event)
+{
+	if (event->key != 0) {
+		gpointer key = GINT_TO_POINTER(event->key);
+		gint count = GPOINTER_TO_INT(g_hash_table_lookup(laneKeys[lane], key)) - 1;
+		if (count > 0) {
+			g_hash_table_insert(laneKeys[lane], key, GINT_TO_POINTER(count));
+		} else {
+			g_hash_table_remove(laneKeys[lane], key);
+		}
+	}
+}
+
+static gint
+compare_seq (gconstpointer a, gconstpointer b)
+{
+	const JawPendingEvent *event_a = (const JawPendingEvent*)a;
+	const JawPendingEvent *event_b = (const JawPendingEvent*)b;
+
+	if (event_a->seq < event_b->seq) {
+		return -1;
+	}
+
+	return event_a->seq > event_b->seq ? 1 : 0;
+}
+
+// A caret move must not overtake the text change before it, nor an
+// active descendant the child added before it
+static void
+promote_earlier_events (gint lane, gint key)
+{
+	GList *earlier = NULL;
+	GList *l;
+	gint lower;
+
+	if (key == 0) {
+		return;
+	}
+
+	for (lower = lane + 1; lower < JAW_EVENT_N_LANES; lower++) {
+		GList *link;
+
+		if (g_hash_table_lookup(laneKeys[lower], GINT_TO_POINTER(key)) == NULL) {
+			continue;
+		}
+
+		link = laneQueues[lower]->head;
+		while (link != NULL) {
+			GList *next = link->next;
+			JawPendingEvent *event = (JawPendingEvent*)link->data;
+
+			if (event->key == key) {
+				lane_forget(lower, event);
+				g_queue_delete_link(laneQueues[lower], link);
+				earlier = g_list_prepend(earlier, event);
+				laneStats[lower].n_promoted++;
+			}
+
+			link = next;
+		}
+	}
+
+	earlier = g_list_sort(earlier, compare_seq);
+	for (l = earlier; l != NULL; l = l->next) {
+		lane_push(lane, (JawPendingEvent*)l->data);
+	}
+	g_list_free(earlier);
+}
+
+static void
+update_pressure_limit (void)
+{
+	pressureLimit = MIN(hardLimit, MAX(queueCapacity, nPendingEvents + queueCapacity / 4));
+}
+
+static gint
+pick_lane (gint64 now)
+{
+	gint lane;
+	gint first = -1;
+	gint starved = -1;
+	gint64 oldest = 0;
+
+	for (lane = 0; lane < JAW_EVENT_N_LANES; lane++) {
+		if (!g_queue_is_empty(laneQueues[lane])) {
+			first = lane;
+			break;
+		}
+	}
+
+	if (first < 0) {
+		return -1;
+	}
+
+	// A lower lane whose head waited too long goes first, oldest wins
+	for (lane = first + 1; lane < JAW_EVENT_N_LANES; lane++) {
+		JawPendingEvent *event = (JawPendingEvent*)g_queue_peek_head(laneQueues[lane]);
+		if (event == NULL
+				|| now - event->enqueue_time < JAW_EVENT_STARVATION_USEC) {
+			continue;
+		}
+
+		if (starved < 0 || event->enqueue_time < oldest) {
+			starved = lane;
+			oldest = event->enqueue_time;
+		}
+	}
+
+	if (starved >= 0) {
+		laneStats[starved].n_starved++;
+		return starved;
+	}
+
+	return first;
+}
+
+static gboolean
+dispatch_events (gpointer p)
+{
+	gint n;
+
+	for (n = 0; n < JAW_EVENT_BATCH_SIZE; n++) {
+		JawPendingEvent *event;
+		gint64 now;
+		gint lane;
+
+		g_mutex_lock(eventQueueMutex);
+
+		now = g_get_monotonic_time();
+		lane = pick_lane(now);
+		if (lane < 0) {
+			dispatchScheduled = FALSE;
+			g_mutex_unlock(eventQueueMutex);
+			return FALSE;
+		}
+
+		event = (JawPendingEvent*)g_queue_pop_head(laneQueues[lane]);
+		lane_forget(lane, event);
+		nPendingEvents--;
+		if (pressureLimit > queueCapacity) {
+			update_pressure_limit();
+		}
+
+		guint64 wait = (guint64)(now - event->enqueue_time);
+		laneStats[lane].n_dispatched++;
+		laneStats[lane].total_wait_usec += wait;
+		if (wait > laneStats[lane].max_wait_usec) {
+			laneStats[lane].max_wait_usec = wait;
+		}
+
+		g_mutex_unlock(eventQueueMutex);
+
+		event->func(event->data);
+		g_free(event);
+	}
+
+	// Yield to the other sources of the context, we come back next iteration
+	return TRUE;
+}
+
+static void
+schedule_dispatch (void)
+{
+	if (eventQueueReady && !dispatchScheduled && nPendingEvents > 0) {
+		dispatchScheduled = TRUE;
+		jaw_event_idle_add(dispatch_events, NULL);
+	}
+}
+
+static void
+destroy_event (JawPendingEvent *event)
+{
+	if (event->destroy) {
+		event->destroy(event->data);
+	}
+
+	g_free(event);
+}
+
+static guint
+event_hash (gconstpointer p)
+{
+	const JawPendingEvent *event = (const JawPendingEvent*)p;
+	return (guint)event->key ^ (event->kind * 2654435761U);
+}
+
+static gboolean
+event_equal (gconstpointer a, gconstpointer b)
+{
+	const JawPendingEvent *event_a = (const JawPendingEvent*)a;
+	const JawPendingEvent *event_b = (const JawPendingEvent*)b;
+	return event_a->key == event_b->key && event_a->kind == event_b->kind;
+}
+
+static void
+compact_lane (gint lane)
+{
+	GHashTable *seen = g_hash_table_new(event_hash, event_equal);
+	GList *link = laneQueues[lane]->head;
+
+	while (link != NULL) {
+		GList *next = link->next;
+		JawPendingEvent *event = (JawPendingEvent*)link->data;
+
+		if (event->kind != 0) {
+			JawPendingEvent *first = (JawPendingEvent*)g_hash_table_lookup(seen, event);
+			if (first == NULL) {
+				g_hash_table_insert(seen, event, event);
+			} else {
+				// The first event of the burst stands in for all of them
+				if (!first->compacted && first->compact != NULL) {
+					first->compact(first->data);
+				}
+				first->compacted = TRUE;
+
+				lane_forget(lane, event);
+				destroy_event(event);
+				g_queue_delete_link(laneQueues[lane], link);
+				nPendingEvents--;
+				laneStats[lane].n_compacted++;
+				queueStats.n_compacted++;
+			}
+		}
+
+		link = next;
+	}
+
+	g_hash_table_destroy(seen);
+}
+
+static void
+drop_oldest_events (guint low_water)
+{
+	gint lane;
+	guint64 n_dropped = queueStats.n_dropped;
+
+	// Focus and window events are never dropped, and neither are
+	// children changes, the AT's tree and the child caches depend on them
+	for (lane = JAW_EVENT_N_LANES - 1; lane > JAW_EVENT_LANE_FOCUS; lane--) {
+		GList *link = laneQueues[lane]->head;
+
+		while (link != NULL && nPendingEvents >= low_water) {
+			GList *next = link->next;
+			JawPendingEvent *event = (JawPendingEvent*)link->data;
+
+			if (event->compact == NULL) {
+				lane_forget(lane, event);
+				destroy_event(event);
+				g_queue_delete_link(laneQueues[lane], link);
+				nPendingEvents--;
+				laneStats[lane].n_dropped++;
+				queueStats.n_dropped++;
+			}
+
+			link = next;
+		}
+	}
+
+	if (queueStats.n_dropped != n_dropped) {
+		g_atomic_int_inc(&dropGeneration);
+	}
+}
+
+/*
+ * Changes after a drop, caches that are only invalidated by events
+ * (such as the children's cached indexes) cannot be trusted across it.
+ */
+guint
+jaw_event_get_drop_generation (void)
+{
+	return (guint)g_atomic_int_get(&dropGeneration);
+}
+
+static void
+relieve_pressure (void)
+{
+	gint lane;
+	guint low_water = queueCapacity - queueCapacity / 4;
+
+	queueStats.n_overflows++;
+
+	for (lane = JAW_EVENT_N_LANES - 1; lane > JAW_EVENT_LANE_FOCUS; lane--) {
+		compact_lane(lane);
+	}
+
+	// Leave some room so the next overflow does not rescan right away
+	drop_oldest_events(low_water);
+	update_pressure_limit();
+}
+
+static JawPendingEvent*
+find_waiting_event (gint key, guint kind)
+{
+	gint lane;
+
+	if (key == 0 || kind == 0) {
+		return NULL;
+	}
+
+	for (lane = 0; lane < JAW_EVENT_N_LANES; lane++) {
+		GList *link;
+
+		if (g_hash_table_lookup(laneKeys[lane], GINT_TO_POINTER(key)) == NULL) {
+			continue;
+		}
+
+		for (link = laneQueues[lane]->head; link != NULL; link = link->next) {
+			JawPendingEvent *event = (JawPendingEvent*)link->data;
+			if (event->key == key && event->kind == kind) {
+				return event;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static void
+evict_event (gint lane, GList *link)
+{
+	JawPendingEvent *event = (JawPendingEvent*)link->data;
+
+	lane_forget(lane, event);
+	destroy_event(event);
+	g_queue_delete_link(laneQueues[lane], link);
+	nPendingEvents--;
+	laneStats[lane].n_dropped++;
+	queueStats.n_dropped++;
+	g_atomic_int_inc(&dropGeneration);
+}
+
+// The oldest bulk or state event that could be dropped, then the
+// oldest focus event, which a newer one supersedes, then any
+static void
+evict_oldest_event (void)
+{
+	gint lane;
+	GList *link;
+
+	for (lane = JAW_EVENT_N_LANES - 1; lane > JAW_EVENT_LANE_FOCUS; lane--) {
+		for (link = laneQueues[lane]->head; link != NULL; link = link->next) {
+			if (((JawPendingEvent*)link->data)->compact == NULL) {
+				evict_event(lane, link);
+				return;
+			}
+		}
+	}
+
+	for (lane = JAW_EVENT_LANE_FOCUS; lane < JAW_EVENT_N_LANES; lane++) {
+		link = laneQueues[lane]->head;
+		if (link != NULL) {
+			evict_event(lane, link);
+			return;
+		}
+	}
+}
+
+/*
+ * The queue is at its hard limit. Returns TRUE if event may still be
+ * queued, otherwise it was merged or refused and is gone.
+ */
+static gboolean
+admit_at_hard_limit (JawEventLane lane, JawPendingEvent *event)
+{
+	JawPendingEvent *waiting = NULL;
+
+	if (event->compact != NULL) {
+		waiting = find_waiting_event(event->key, event->kind);
+	}
+
+	if (waiting != NULL) {
+		if (!waiting->compacted) {
+			waiting->compact(waiting->data);
+		}
+		waiting->compacted = TRUE;
+		// It stands in for the new event, so it must not wait behind it
+		promote_earlier_events(lane, event->key);
+		destroy_event(event);
+		laneStats[lane].n_compacted++;
+		queueStats.n_compacted++;
+		return FALSE;
+	}
+
+	if (lane == JAW_EVENT_LANE_FOCUS) {
+		evict_oldest_event();
+		return TRUE;
+	}
+
+	destroy_event(event);
+	queueStats.n_refused++;
+	g_atomic_int_inc(&dropGeneration);
+	return FALSE;
+}
+
+void
+jaw_event_post_compactable (JawEventLane lane,
+		GSourceFunc func,
+		gpointer data,
+		GDestroyNotify destroy,
+		gint key,
+		guint kind,
+		JawEventCompactFunc compact)
+{
+	JawPendingEvent *event = g_new(JawPendingEvent, 1);
+	event->func = func;
+	event->data = data;
+	event->destroy = destroy;
+	event->enqueue_time = g_get_monotonic_time();
+	event->key = key;
+	event->kind = kind;
+	event->compact = compact;
+	event->compacted = FALSE;
+
+	g_mutex_lock(eventQueueMutex);
+
+	if (nPendingEvents >= pressureLimit) {
+		relieve_pressure();
+	}
+
+	if (nPendingEvents >= hardLimit && !admit_at_hard_limit(lane, event)) {
+		g_mutex_unlock(eventQueueMutex);
+		return;
+	}
+
+	event->seq = nextSeq++;
+	promote_earlier_events(lane, key);
+	lane_push(lane, event);
+	nPendingEvents++;
+	if (nPendingEvents > queueStats.peak_pending) {
+		queueStats.peak_pending = nPendingEvents;
+	}
+
+	schedule_dispatch();
+
+	g_mutex_unlock(eventQueueMutex);
+}
+
+void
+jaw_event_post (JawEventLane lane,
+		GSourceFunc func,
+		gpointer data,
+		GDestroyNotify destroy)
+{
+	jaw_event_post_compactable(lane, func, data, destroy, 0, 0, NULL);
+}
+
+void
+jaw_event_queue_set_ready (void)
+{
+	g_mutex_lock(eventQueueMutex);
+
+	eventQueueReady = TRUE;
+	schedule_dispatch();
+
+	g_mutex_unlock(eventQueueMutex);
+}
+
+gboolean
+jaw_event_queue_is_ready (void)
+{
+	gboolean ready;
+
+	g_mutex_lock(eventQueueMutex);
+	ready = eventQueueReady;
+	g_mutex_unlock(eventQueueMutex);
+
+	return ready;
+}
+
+void
+jaw_event_queue_get_stats (JawEventQueueStats *stats)
+{
+	g_mutex_lock(eventQueueMutex);
+	*stats = queueStats;
+	stats->n_pending = nPendingEvents;
+	g_mutex_unlock(eventQueueMutex);
+}
+
+void
+jaw_event_queue_get_lane_stats (JawEventLane lane, JawEventLaneStats *stats)
+{
+	g_mutex_lock(eventQueueMutex);
+	*stats = laneStats[lane];
+	g_mutex_unlock(eventQueueMutex);
+}
+
+void
+jaw_event_queue_dump_stats (void)
+{
+	gint lane;
+	JawEventQueueStats queue_stats;
+
+	jaw_event_queue_get_stats(&queue_stats);
+	g_printerr("Event queue: capacity %u, hard limit %u, %u pending, peak %u, %"
+			G_GUINT64_FORMAT " overflows, %" G_GUINT64_FORMAT " compacted, %"
+			G_GUINT64_FORMAT " dropped, %" G_GUINT64_FORMAT " refused\n",
+			queue_stats.capacity, queue_stats.hard_limit, queue_stats.n_pending,
+			queue_stats.peak_pending, queue_stats.n_overflows, queue_stats.n_compacted,
+			queue_stats.n_dropped, queue_stats.n_refused);
+
+	for (lane = 0; lane < JAW_EVENT_N_LANES; lane++) {
+		JawEventLaneStats stats;
+		jaw_event_queue_get_lane_stats(lane, &stats);
+
+		guint64 avg = stats.n_dispatched > 0
+			? stats.total_wait_usec / stats.n_dispatched : 0;
+
+		g_printerr("Event lane %s: %" G_GUINT64_FORMAT " dispatched, wait avg %"
+				G_GUINT64_FORMAT " us max %" G_GUINT64_FORMAT " us, %"
+				G_GUINT64_FORMAT " starvation picks, %" G_GUINT64_FORMAT
+				" promoted, %" G_GUINT64_FORMAT " compacted, %"
+				G_GUINT64_FORMAT " dropped\n",
+				laneNames[lane], stats.n_dispatched, avg,
+				stats.max_wait_usec, stats.n_starved, stats.n_promoted,
+				stats.n_compacted, stats.n_dropped);
+	}
+}
+
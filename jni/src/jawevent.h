@@ -0,0 +1,99 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_EVENT_H_
+#define _JAW_EVENT_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+// Default capacity, JAW_EVENT_QUEUE_SIZE overrides it
+#define JAW_EVENT_QUEUE_SIZE		4096
+#define JAW_EVENT_QUEUE_MIN_SIZE	64
+
+// The queue never holds more than this many times its capacity
+#define JAW_EVENT_QUEUE_HARD_FACTOR	2
+
+// Events handled per main loop iteration before yielding
+#define JAW_EVENT_BATCH_SIZE		32
+
+// A lower lane is served once its oldest event waited this long
+#define JAW_EVENT_STARVATION_USEC	(100 * 1000)
+
+typedef enum _JawEventLane {
+	JAW_EVENT_LANE_FOCUS = 0,	// keyboard, focus and window events
+	JAW_EVENT_LANE_STATE,		// state, name, description, selection
+	JAW_EVENT_LANE_BULK,		// children, text and table changes
+	JAW_EVENT_N_LANES
+} JawEventLane;
+
+// Turns a kept event into the summary of the burst it absorbed
+typedef void (*JawEventCompactFunc) (gpointer data);
+
+typedef struct _JawEventLaneStats {
+	guint64 n_dispatched;
+	guint64 total_wait_usec;
+	guint64 max_wait_usec;
+	guint64 n_starved;
+	guint64 n_promoted;
+	guint64 n_compacted;
+	guint64 n_dropped;
+} JawEventLaneStats;
+
+typedef struct _JawEventQueueStats {
+	guint capacity;
+	guint hard_limit;
+	guint n_pending;
+	guint peak_pending;
+	guint64 n_overflows;
+	guint64 n_compacted;
+	guint64 n_dropped;
+	guint64 n_refused;
+} JawEventQueueStats;
+
+void		jaw_event_queue_init(void);
+GMainContext*	jaw_event_queue_get_context(void);
+void		jaw_event_queue_attach(GMainContext *context);
+guint		jaw_event_idle_add(GSourceFunc func, gpointer data);
+void		jaw_event_queue_set_ready(void);
+gboolean	jaw_event_queue_is_ready(void);
+guint		jaw_event_get_drop_generation(void);
+void		jaw_event_post(JawEventLane lane,
+			GSourceFunc func,
+			gpointer data,
+			GDestroyNotify destroy);
+// key names the object, its events keep their order across lanes.
+// Events with a compact function are collapsed but never dropped
+void		jaw_event_post_compactable(JawEventLane lane,
+			GSourceFunc func,
+			gpointer data,
+			GDestroyNotify destroy,
+			gint key,
+			guint kind,
+			JawEventCompactFunc compact);
+void		jaw_event_queue_get_stats(JawEventQueueStats *stats);
+void		jaw_event_queue_get_lane_stats(JawEventLane lane,
+			JawEventLaneStats *stats);
+void		jaw_event_queue_dump_stats(void);
+
+G_END_DECLS
+
+#endif
+
@@ -23,6 +23,8 @@
 #include "jawutil.h"
 #include "jawimpl.h"
 #include "jawtoplevel.h"
+#include "jawsnapshot.h"
+#include "jawevent.h"
 
 static void			jaw_impl_class_init			(JawImplClass		*klass);
 //static void			jaw_impl_init				(JawImpl		*impl);
@@ -77,10 +79,14 @@ extern gpointer	jaw_table_data_init (jobject);
 extern void	jaw_table_data_finalize (gpointer);
 
 typedef struct _JawInterfaceInfo {
+	gpointer (*init) (jobject);
 	void (*finalize) (gpointer);
 	gpointer data;
 } JawInterfaceInfo;
 
+static void			virtual_window_free			(JNIEnv			*jniEnv,
+									 JawVirtualWindow	*window);
+
 static gpointer			jaw_impl_parent_class = NULL;
 
 static GHashTable *typeTable = NULL;
@@ -94,45 +100,121 @@ jaw_impl_init_mutex ()
 		objectTableMutex = g_mutex_new();
 }
 
+static gsize identityHashCodeInit = 0;
+static jclass classSystem = NULL;
+static jmethodID identityHashCodeMethod = NULL;
+
+/*
+ * Wrappers are keyed by the identity hash of their AccessibleContext.
+ * The Java side computes the same value with System.identityHashCode
+ * and passes it along with each event, see jaw_impl_ref_instance_by_key.
+ */
+gint
+jaw_impl_get_object_key (JNIEnv *jniEnv, jobject ac)
+{
+	if (g_once_init_enter(&identityHashCodeInit)) {
+		jclass localClass = (*jniEnv)->FindClass(jniEnv, "java/lang/System");
+		classSystem = (*jniEnv)->NewGlobalRef(jniEnv, localClass);
+		(*jniEnv)->DeleteLocalRef(jniEnv, localClass);
+		identityHashCodeMethod = (*jniEnv)->GetStaticMethodID(jniEnv, classSystem,
+				"identityHashCode", "(Ljava/lang/Object;)I");
+		g_once_init_leave(&identityHashCodeInit, 1);
+	}
+
+	return (gint)(*jniEnv)->CallStaticIntMethod(jniEnv, classSystem,
+			identityHashCodeMethod, ac);
+}
+
+/*
+ * The table only holds weak references, a wrapper leaves it when its
+ * last reference goes. impl is kept to recognize the entry on removal
+ * and is never dereferenced.
+ */
+typedef struct _ObjectTableEntry {
+	GWeakRef ref;
+	JawImpl *impl;
+} ObjectTableEntry;
+
 static void
-object_table_insert ( JNIEnv *jniEnv, jobject ac, JawImpl * jaw_impl )
+object_table_entry_free (gpointer data)
 {
-	jclass classAccessibleContext = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/AccessibleContext" );
-	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "hashCode", "()I" );
-	gint hash_key = (gint)(*jniEnv)->CallIntMethod( jniEnv, ac, jmid );
+	ObjectTableEntry *entry = (ObjectTableEntry*)data;
+
+	g_weak_ref_clear(&entry->ref);
+	g_free(entry);
+}
+
+static void
+object_table_insert (gint hash_key, JawImpl * jaw_impl)
+{
+	ObjectTableEntry *entry = g_new0(ObjectTableEntry, 1);
+
+	g_weak_ref_init(&entry->ref, jaw_impl);
+	entry->impl = jaw_impl;
 
 	g_mutex_lock(objectTableMutex);
-	g_hash_table_insert(objectTable, (gpointer)hash_key, (gpointer)jaw_impl);
+	if (objectTable == NULL) {
+		objectTable = g_hash_table_new_full(NULL, NULL, NULL, object_table_entry_free);
+	}
+	g_hash_table_insert(objectTable, (gpointer)hash_key, (gpointer)entry);
 	g_mutex_unlock(objectTableMutex);
 }
 
+// Returns a new reference, or NULL once the last one is gone
 static JawImpl*
-object_table_lookup ( JNIEnv *jniEnv, jobject ac )
+object_table_ref (gint hash_key)
 {
-	jclass classAccessibleContext = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/AccessibleContext" );
-	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "hashCode", "()I" );
-	gint hash_key = (gint)(*jniEnv)->CallIntMethod( jniEnv, ac, jmid );
+	ObjectTableEntry *entry = NULL;
 	gpointer value = NULL;
-	
+
 	g_mutex_lock(objectTableMutex);
-	value = g_hash_table_lookup(objectTable, (gpointer)hash_key);
+	if (objectTable != NULL) {
+		entry = (ObjectTableEntry*)g_hash_table_lookup(objectTable, (gpointer)hash_key);
+	}
+	if (entry != NULL) {
+		value = g_weak_ref_get(&entry->ref);
+	}
 	g_mutex_unlock(objectTableMutex);
 
 	return (JawImpl*)value;
 }
 
+// Keys are identity hash codes, two live contexts can share one
+static gboolean
+is_instance_of (JNIEnv *jniEnv, JawImpl *jaw_impl, jobject ac)
+{
+	jobject acc_context = JAW_OBJECT(jaw_impl)->acc_context;
+
+	if (ac == NULL) {
+		return TRUE;
+	}
+
+	return acc_context != NULL && (*jniEnv)->IsSameObject(jniEnv, ac, acc_context);
+}
+
 static void
-object_table_remove (JNIEnv *jniEnv, jobject ac )
+object_table_remove (gint hash_key, JawImpl *jaw_impl)
 {
-	jclass classAccessibleContext = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/AccessibleContext" );
-	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "hashCode", "()I" );
-	gint hash_key = (gint)(*jniEnv)->CallIntMethod( jniEnv, ac, jmid );
-	
+	ObjectTableEntry *entry;
+
 	g_mutex_lock(objectTableMutex);
-	g_hash_table_remove( objectTable, (gpointer)hash_key );
+	entry = (ObjectTableEntry*)g_hash_table_lookup(objectTable, (gpointer)hash_key);
+	// Another wrapper may have taken over the key meanwhile
+	if (entry != NULL && entry->impl == jaw_impl) {
+		g_hash_table_remove( objectTable, (gpointer)hash_key );
+	}
 	g_mutex_unlock(objectTableMutex);
 }
 
+// What eager helper creation would have cost, against what was used
+typedef struct _JawHelperStats {
+	guint64 n_wrappers;
+	guint64 n_interfaces;
+	guint64 n_helpers;
+} JawHelperStats;
+
+static JawHelperStats helperStats;
+
 static void
 aggregate_interface (JNIEnv *jniEnv,
 		JawObject *jaw_obj,
@@ -140,120 +222,354 @@ aggregate_interface (JNIEnv *jniEnv,
 {
 	JawImpl *jaw_impl = JAW_IMPL(tflag, jaw_obj);
 
-	jobject ac = jaw_obj->acc_context;
+	// Java helpers are only created once an interface is first used,
+	// see jaw_impl_get_interface_data
 	jaw_impl->ifaceTable = g_hash_table_new(NULL, NULL);
 
 	if (tflag & INTERFACE_ACTION) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_action_data_init(ac);
+		info->init = jaw_action_data_init;
+		info->data = NULL;
 		info->finalize = jaw_action_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_ACTION, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_COMPONENT) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_component_data_init(ac);
+		info->init = jaw_component_data_init;
+		info->data = NULL;
 		info->finalize = jaw_component_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_COMPONENT, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_TEXT) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_text_data_init(ac);
+		info->init = jaw_text_data_init;
+		info->data = NULL;
 		info->finalize = jaw_text_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_TEXT, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_EDITABLE_TEXT) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_editable_text_data_init(ac);
+		info->init = jaw_editable_text_data_init;
+		info->data = NULL;
 		info->finalize = jaw_editable_text_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_EDITABLE_TEXT, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_HYPERTEXT) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_hypertext_data_init(ac);
+		info->init = jaw_hypertext_data_init;
+		info->data = NULL;
 		info->finalize = jaw_hypertext_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_HYPERTEXT, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_IMAGE) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_image_data_init(ac);
+		info->init = jaw_image_data_init;
+		info->data = NULL;
 		info->finalize = jaw_image_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_IMAGE, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_SELECTION) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_selection_data_init(ac);
+		info->init = jaw_selection_data_init;
+		info->data = NULL;
 		info->finalize = jaw_selection_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_SELECTION, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_VALUE) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_value_data_init(ac);
+		info->init = jaw_value_data_init;
+		info->data = NULL;
 		info->finalize = jaw_value_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_VALUE, (gpointer)info);
 	}
 
 	if (tflag & INTERFACE_TABLE) {
 		JawInterfaceInfo *info = g_new(JawInterfaceInfo, 1);
-		info->data = jaw_table_data_init(ac);
+		info->init = jaw_table_data_init;
+		info->data = NULL;
 		info->finalize = jaw_table_data_finalize;
 		g_hash_table_insert(jaw_impl->ifaceTable, (gpointer)INTERFACE_TABLE, (gpointer)info);
 	}
+
+	helperStats.n_wrappers++;
+	helperStats.n_interfaces += g_hash_table_size(jaw_impl->ifaceTable);
+}
+
+static void
+call_property_change_listener (JNIEnv *jniEnv, jobject ac, const gchar *method)
+{
+	jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkWrapper");
+	jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv, classAtkWrapper, method, "(Ljavax/accessibility/AccessibleContext;)V");
+	(*jniEnv)->CallStaticVoidMethod(jniEnv, classAtkWrapper, jmid, ac);
+}
+
+static JawImpl*
+create_instance (JNIEnv *jniEnv, jobject ac, gint hash_key, guint tflag)
+{
+	jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, ac);
+	JawImpl *jaw_impl = g_object_new( JAW_TYPE_IMPL(tflag), NULL );
+	jaw_impl->hash_key = hash_key;
+	jaw_impl->virtual_window = NULL;
+	jaw_impl->child_prefetch = NULL;
+	JawObject *jaw_obj = JAW_OBJECT(jaw_impl);
+	jaw_obj->acc_context = global_ac;
+	aggregate_interface(jniEnv, jaw_obj, tflag);
+	jaw_snapshot_take_pending(jaw_obj, hash_key);
+
+	atk_object_initialize( ATK_OBJECT(jaw_impl), NULL );
+
+	object_table_insert( hash_key, jaw_impl );
+
+	return jaw_impl;
 }
 
 JawImpl*
 jaw_impl_get_instance (JNIEnv *jniEnv, jobject ac)
 {
-	JawImpl *jaw_impl;
+	return jaw_impl_get_instance_by_key(jniEnv, ac,
+			jaw_impl_get_object_key(jniEnv, ac));
+}
 
+/*
+ * Like jaw_impl_get_instance, for callers that already know the key
+ * of ac. Java is only called if the wrapper has to be created.
+ */
+JawImpl*
+jaw_impl_get_instance_by_key (JNIEnv *jniEnv, jobject ac, gint hash_key)
+{
+	JawImpl *jaw_impl = jaw_impl_find_instance_by_key(jniEnv, ac, hash_key);
+
+	if (jaw_impl == NULL) {
+		guint tflag = jaw_util_get_tflag_from_jobj(jniEnv, ac);
+		jaw_impl = create_instance(jniEnv, ac, hash_key, tflag);
+	}
+
+	return jaw_impl;
+}
+
+JawImpl*
+jaw_impl_find_instance (JNIEnv *jniEnv, jobject ac)
+{
 	g_mutex_lock(objectTableMutex);
 	if (objectTable == NULL) {
-		objectTable = g_hash_table_new ( NULL, NULL );
+		g_mutex_unlock(objectTableMutex);
+		return NULL;
 	}
 	g_mutex_unlock(objectTableMutex);
-	
-	jaw_impl = object_table_lookup( jniEnv, ac );
 
-	if (jaw_impl == NULL) {
-		jobject global_ac = (*jniEnv)->NewGlobalRef(jniEnv, ac);
-		guint tflag = jaw_util_get_tflag_from_jobj(jniEnv, global_ac);
-		jaw_impl = g_object_new( JAW_TYPE_IMPL(tflag), NULL );
-		JawObject *jaw_obj = JAW_OBJECT(jaw_impl);
-		jaw_obj->acc_context = global_ac;
-		jaw_obj->storedData = g_hash_table_new(g_str_hash, g_str_equal);
-		aggregate_interface(jniEnv, jaw_obj, tflag);
+	return jaw_impl_find_instance_by_key(jniEnv, ac,
+			jaw_impl_get_object_key(jniEnv, ac));
+}
 
-		atk_object_initialize( ATK_OBJECT(jaw_impl), NULL );
+/*
+ * Pure native lookup, safe on threads that should not call into Java.
+ * If ac is given the wrapper must belong to it, not just to its key.
+ */
+JawImpl*
+jaw_impl_find_instance_by_key (JNIEnv *jniEnv, jobject ac, gint hash_key)
+{
+	JawImpl *jaw_impl = jaw_impl_ref_instance_by_key(jniEnv, ac, hash_key);
 
-		object_table_insert( jniEnv, global_ac, jaw_impl);
+	// Borrowed, the caller's own references keep it alive
+	if (jaw_impl != NULL) {
+		g_object_unref(jaw_impl);
 	}
 
 	return jaw_impl;
 }
 
+/*
+ * Like jaw_impl_find_instance_by_key, but returns a new reference. A
+ * wrapper whose last reference is already gone is treated as missing,
+ * GWeakRef will not hand it out again.
+ */
 JawImpl*
-jaw_impl_find_instance (JNIEnv *jniEnv, jobject ac)
+jaw_impl_ref_instance_by_key (JNIEnv *jniEnv, jobject ac, gint hash_key)
 {
-	JawImpl *jaw_impl;
+	JawImpl *jaw_impl = object_table_ref( hash_key );
 
-	g_mutex_lock(objectTableMutex);
-	if (objectTable == NULL) {
-		g_mutex_unlock(objectTableMutex);
+	if (jaw_impl != NULL && !is_instance_of(jniEnv, jaw_impl, ac)) {
+		g_object_unref(jaw_impl);
 		return NULL;
 	}
-	g_mutex_unlock(objectTableMutex);
 
-	jaw_impl = object_table_lookup( jniEnv, ac );
+	return jaw_impl;
+}
+
+/*
+ * Children of containers with more than JAW_VIRTUAL_THRESHOLD children
+ * are kept in a window of JAW_VIRTUAL_WINDOW indexes around the last
+ * one asked for. Wrappers leaving the window are released.
+ *
+ * Their shells are not pooled for other children. Each wrapper went
+ * out through ref_child, and the bridge may still export it through a
+ * weak reference that is not visible from here. A rebound shell would
+ * give the AT's object another identity, so only the live wrappers are
+ * bounded, not the GObjects created while scrolling.
+ */
+struct _JawVirtualWindow {
+	guint generation;
+	guint drop_generation;
+	gboolean active;
+	gint center;
+	GHashTable *children;	// index -> JawImpl, holding a reference
+};
+
+typedef struct _JawVirtualStats {
+	guint64 n_hits;
+	guint64 n_created;
+	guint64 n_released;
+} JawVirtualStats;
+
+static guint virtualThreshold = 0;
+static guint virtualWindowSize = JAW_VIRTUAL_WINDOW_SIZE;
+static JawVirtualStats virtualStats;
+
+void
+jaw_impl_init_virtual (void)
+{
+	const gchar *threshold_env = g_getenv("JAW_VIRTUAL_THRESHOLD");
+	if (threshold_env == NULL) {
+		return;
+	}
+
+	virtualThreshold = (guint)MIN(g_ascii_strtoull(threshold_env, NULL, 10), G_MAXINT);
+
+	const gchar *window_env = g_getenv("JAW_VIRTUAL_WINDOW");
+	if (window_env != NULL) {
+		guint64 size = g_ascii_strtoull(window_env, NULL, 10);
+		virtualWindowSize = (guint)CLAMP(size, JAW_VIRTUAL_WINDOW_MIN_SIZE, G_MAXINT);
+	}
+}
+
+static void
+virtual_child_release (JNIEnv *jniEnv, JawImpl *jaw_impl)
+{
+	virtualStats.n_released++;
+	g_object_unref(G_OBJECT(jaw_impl));
+}
+
+typedef struct _VirtualTrimData {
+	JNIEnv *jniEnv;
+	JawVirtualWindow *window;
+	gboolean all;
+} VirtualTrimData;
+
+static gboolean
+virtual_child_trim (gpointer key, gpointer value, gpointer data)
+{
+	VirtualTrimData *trim = (VirtualTrimData*)data;
+	gint index = GPOINTER_TO_INT(key);
+
+	if (!trim->all && ABS(index - trim->window->center) <= (gint)virtualWindowSize / 2) {
+		return FALSE;
+	}
+
+	virtual_child_release(trim->jniEnv, (JawImpl*)value);
+
+	return TRUE;
+}
+
+static void
+virtual_window_trim (JNIEnv *jniEnv, JawVirtualWindow *window, gboolean all)
+{
+	VirtualTrimData trim = { jniEnv, window, all };
+	g_hash_table_foreach_remove(window->children, virtual_child_trim, &trim);
+}
+
+static void
+virtual_window_free (JNIEnv *jniEnv, JawVirtualWindow *window)
+{
+	virtual_window_trim(jniEnv, window, TRUE);
+	g_hash_table_destroy(window->children);
+	g_free(window);
+}
+
+// The window of jaw_impl if it has enough children to be virtualized
+static JawVirtualWindow*
+virtual_window_get (JawImpl *jaw_impl)
+{
+	JawObject *jaw_obj = JAW_OBJECT(jaw_impl);
+	JawVirtualWindow *window = jaw_impl->virtual_window;
+
+	if (virtualThreshold == 0) {
+		return NULL;
+	}
+
+	if (window == NULL) {
+		window = g_new0(JawVirtualWindow, 1);
+		window->children = g_hash_table_new(NULL, NULL);
+		window->generation = jaw_obj->children_generation - 1;
+		jaw_impl->virtual_window = window;
+	}
+
+	// Children moved, the indexes we hold are meaningless now. After a
+	// drop the event saying so may be lost.
+	if (window->generation != jaw_obj->children_generation
+			|| window->drop_generation != jaw_event_get_drop_generation()) {
+		virtual_window_trim(jaw_util_get_jni_env(), window, TRUE);
+		window->generation = jaw_obj->children_generation;
+		window->drop_generation = jaw_event_get_drop_generation();
+		window->active = atk_object_get_n_accessible_children(ATK_OBJECT(jaw_impl))
+			> (gint)virtualThreshold;
+	}
+
+	return window->active ? window : NULL;
+}
+
+static JawImpl*
+virtual_window_add (JNIEnv *jniEnv, JawVirtualWindow *window, jobject ac, gint index)
+{
+	gint hash_key = jaw_impl_get_object_key(jniEnv, ac);
+	JawImpl *jaw_impl = jaw_impl_find_instance_by_key(jniEnv, ac, hash_key);
+
+	if (jaw_impl != NULL) {
+		// The window holds its own reference
+		g_object_ref(G_OBJECT(jaw_impl));
+	} else {
+		guint tflag = jaw_util_get_tflag_from_jobj(jniEnv, ac);
+		jaw_impl = create_instance(jniEnv, ac, hash_key, tflag);
+		virtualStats.n_created++;
+	}
+
+	g_hash_table_insert(window->children, GINT_TO_POINTER(index), jaw_impl);
+	window->center = index;
+
+	if (g_hash_table_size(window->children) > virtualWindowSize) {
+		virtual_window_trim(jniEnv, window, FALSE);
+	}
 
 	return jaw_impl;
 }
 
+void
+jaw_impl_dump_virtual_stats (void)
+{
+	if (virtualThreshold == 0) {
+		return;
+	}
+
+	g_printerr("Virtual children: window %u, %" G_GUINT64_FORMAT " hits, %"
+			G_GUINT64_FORMAT " created, %" G_GUINT64_FORMAT " released\n",
+			virtualWindowSize, virtualStats.n_hits, virtualStats.n_created,
+			virtualStats.n_released);
+}
+
+void
+jaw_impl_dump_helper_stats (void)
+{
+	g_printerr("Interface helpers: %" G_GUINT64_FORMAT " wrappers, %"
+			G_GUINT64_FORMAT " interfaces, %" G_GUINT64_FORMAT " helpers created\n",
+			helperStats.n_wrappers, helperStats.n_interfaces, helperStats.n_helpers);
+}
+
 static void
 jaw_impl_class_intern_init (gpointer klass)
 {
@@ -433,6 +749,11 @@ jaw_impl_init(JawImpl *impl)
 static void
 jaw_impl_dispose(GObject *gobject)
 {
+	JawImpl *jaw_impl = (JawImpl*)gobject;
+
+	// The weak reference is already cleared, lookups cannot revive it
+	object_table_remove(jaw_impl->hash_key, jaw_impl);
+
 	/* Chain up to parent's dispose */
 	G_OBJECT_CLASS(jaw_impl_parent_class)->dispose(gobject);
 }
@@ -446,7 +767,15 @@ jaw_impl_finalize(GObject *gobject)
 	JawImpl *jaw_impl = (JawImpl*)jaw_obj;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	object_table_remove( jniEnv, global_ac );
+	object_table_remove( jaw_impl->hash_key, jaw_impl );
+
+	if (jaw_impl->virtual_window != NULL) {
+		virtual_window_free(jniEnv, jaw_impl->virtual_window);
+		jaw_impl->virtual_window = NULL;
+	}
+
+	jaw_prefetch_free(jniEnv, jaw_impl->child_prefetch);
+	jaw_impl->child_prefetch = NULL;
 
 	(*jniEnv)->DeleteGlobalRef(jniEnv, global_ac);
 	jaw_obj->acc_context = NULL;
@@ -459,7 +788,9 @@ jaw_impl_finalize(GObject *gobject)
 	g_hash_table_iter_init(&iter, jaw_impl->ifaceTable);
 	while (g_hash_table_iter_next(&iter, &key, &value)) {
 		JawInterfaceInfo *info = (JawInterfaceInfo*)value;
-		info->finalize(info->data);
+		if (info->data != NULL) {
+			info->finalize(info->data);
+		}
 
 		g_free(info);
 
@@ -467,8 +798,6 @@ jaw_impl_finalize(GObject *gobject)
 	}
 	g_hash_table_unref(jaw_impl->ifaceTable);
 
-	g_hash_table_destroy(jaw_obj->storedData);
-
 	/* Chain up to parent's finalize */
 	G_OBJECT_CLASS(jaw_impl_parent_class)->finalize(gobject);
 }
@@ -485,6 +814,11 @@ jaw_impl_get_interface_data (JawObject *jaw_obj, guint iface)
 	JawInterfaceInfo *info = g_hash_table_lookup(jaw_impl->ifaceTable, (gpointer)iface);
 
 	if (info) {
+		if (info->data == NULL) {
+			info->data = info->init(jaw_obj->acc_context);
+			helperStats.n_helpers++;
+		}
+
 		return info->data;
 	}
 
@@ -500,9 +834,7 @@ jaw_impl_initialize (AtkObject *atk_obj, gpointer data)
 	jobject ac = jaw_obj->acc_context;
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
-	jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkWrapper");
-	jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv, classAtkWrapper, "registerPropertyChangeListener", "(Ljavax/accessibility/AccessibleContext;)V");
-	(*jniEnv)->CallStaticVoidMethod(jniEnv, classAtkWrapper, jmid, ac);
+	call_property_change_listener(jniEnv, ac, "registerPropertyChangeListener");
 }
 
 static AtkObject*
@@ -513,6 +845,11 @@ jaw_impl_get_parent (AtkObject *atk_obj)
 	}
 
 	JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+	JawObject *parent = jaw_object_get_cached_parent(jaw_obj);
+	if (parent != NULL) {
+		return ATK_OBJECT(parent);
+	}
+
 	jobject ac = jaw_obj->acc_context;
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
@@ -524,8 +861,9 @@ jaw_impl_get_parent (AtkObject *atk_obj)
 		jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessible, "getAccessibleContext", "()Ljavax/accessibility/AccessibleContext;");
 		jobject parent_ac = (*jniEnv)->CallObjectMethod( jniEnv, jparent, jmid );
 
-		AtkObject *obj = (AtkObject*) object_table_lookup( jniEnv, parent_ac );
+		AtkObject *obj = (AtkObject*) jaw_impl_find_instance( jniEnv, parent_ac );
 		if (obj != NULL ) {
+			jaw_object_set_cached_parent(jaw_obj, JAW_OBJECT(obj), -1);
 			return obj;
 		}
 	}
@@ -533,13 +871,37 @@ jaw_impl_get_parent (AtkObject *atk_obj)
 	return ATK_OBJECT(atk_get_root());
 }
 
-static AtkObject*
-jaw_impl_ref_child (AtkObject *atk_obj,
-			gint i)
+// Children walked in order are fetched ahead, see jawprefetch.h
+static jobject
+ref_child_context (JNIEnv *jniEnv, JawImpl *jaw_impl, gint i)
 {
-	JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+	JawObject *jaw_obj = JAW_OBJECT(jaw_impl);
 	jobject ac = jaw_obj->acc_context;
-	JNIEnv *jniEnv = jaw_util_get_jni_env();
+
+	if (jaw_prefetch_get_depth() > 0) {
+		if (jaw_impl->child_prefetch == NULL) {
+			jaw_impl->child_prefetch = jaw_prefetch_new(JAW_PREFETCH_CHILDREN);
+		}
+
+		JawPrefetch *prefetch = jaw_impl->child_prefetch;
+		if (jaw_prefetch_lookup(jniEnv, prefetch, 0, i, i + 1, jaw_obj->children_generation)) {
+			return jaw_prefetch_get_object(jniEnv, prefetch, i);
+		}
+
+		if (jaw_prefetch_should_fetch(prefetch)) {
+			jclass classAtkWrapper = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkWrapper");
+			jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv, classAtkWrapper, "getAccessibleChildren", "(Ljavax/accessibility/AccessibleContext;II)[Ljavax/accessibility/AccessibleContext;");
+			jobjectArray jchildren = (*jniEnv)->CallStaticObjectMethod(jniEnv, classAtkWrapper, jmid,
+					ac, (jint)i, (jint)jaw_prefetch_get_depth());
+			if (jchildren != NULL) {
+				jsize n = (*jniEnv)->GetArrayLength(jniEnv, jchildren);
+				jaw_prefetch_store(jniEnv, prefetch, jchildren, i, i + n, jaw_obj->children_generation);
+				if (n > 0) {
+					return jaw_prefetch_get_object(jniEnv, prefetch, i);
+				}
+			}
+		}
+	}
 
 	jclass classAccessibleContext = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/AccessibleContext" );
 	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "getAccessibleChild", "(I)Ljavax/accessibility/Accessible;" );
@@ -550,11 +912,47 @@ jaw_impl_ref_child (AtkObject *atk_obj,
 
 	jclass classAccessible = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/Accessible" );
 	jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessible, "getAccessibleContext", "()Ljavax/accessibility/AccessibleContext;" );
-	jobject child_ac = (*jniEnv)->CallObjectMethod( jniEnv, jchild, jmid );
+	return (*jniEnv)->CallObjectMethod( jniEnv, jchild, jmid );
+}
+
+static AtkObject*
+jaw_impl_ref_child (AtkObject *atk_obj,
+			gint i)
+{
+	JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+	JNIEnv *jniEnv = jaw_util_get_jni_env();
+	AtkObject *obj;
 
-	AtkObject *obj = (AtkObject*) jaw_impl_get_instance( jniEnv, child_ac );
+	if (jaw_snapshot_is_enabled()
+			&& jaw_toplevel_get_child_index(JAW_TOPLEVEL(atk_get_root()), atk_obj) != -1) {
+		jaw_snapshot_ensure(jniEnv, jaw_obj);
+	}
+
+	JawVirtualWindow *window = virtual_window_get((JawImpl*)jaw_obj);
+	if (window != NULL) {
+		obj = (AtkObject*)g_hash_table_lookup(window->children, GINT_TO_POINTER(i));
+		if (obj != NULL) {
+			virtualStats.n_hits++;
+			window->center = i;
+			g_object_ref (G_OBJECT(obj));
+			return obj;
+		}
+	}
+
+	jobject child_ac = ref_child_context(jniEnv, (JawImpl*)jaw_obj, i);
+	if (child_ac == NULL) {
+		return NULL;
+	}
+
+	if (window != NULL) {
+		obj = (AtkObject*) virtual_window_add( jniEnv, window, child_ac, i );
+	} else {
+		obj = (AtkObject*) jaw_impl_get_instance( jniEnv, child_ac );
+	}
 	g_object_ref (G_OBJECT(obj));
 
+	jaw_object_set_cached_parent(JAW_OBJECT(obj), jaw_obj, i);
+
 	return obj;
 }
 
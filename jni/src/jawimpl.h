@@ -21,6 +21,7 @@
 #define _JAW_IMPL_H_
 
 #include "jawobject.h"
+#include "jawprefetch.h"
 
 G_BEGIN_DECLS
 
@@ -33,17 +34,33 @@ G_BEGIN_DECLS
 
 typedef struct _JawImpl			JawImpl;
 typedef struct _JawImplClass		JawImplClass;
+typedef struct _JawVirtualWindow	JawVirtualWindow;
+
+// Children kept around the last index asked for, JAW_VIRTUAL_WINDOW overrides it
+#define JAW_VIRTUAL_WINDOW_SIZE		256
+#define JAW_VIRTUAL_WINDOW_MIN_SIZE	16
 
 struct _JawImpl
 {
 	JawObject parent;
 
 	GHashTable *ifaceTable;
+	gint hash_key;
+	// Only for containers with more than JAW_VIRTUAL_THRESHOLD children
+	JawVirtualWindow *virtual_window;
+	JawPrefetch *child_prefetch;
 };
 
 void jaw_impl_init_mutex();
+void jaw_impl_init_virtual(void);
+void jaw_impl_dump_virtual_stats(void);
+void jaw_impl_dump_helper_stats(void);
 JawImpl* jaw_impl_get_instance(JNIEnv*, jobject);
 JawImpl* jaw_impl_find_instance(JNIEnv*, jobject);
+JawImpl* jaw_impl_get_instance_by_key(JNIEnv*, jobject, gint);
+JawImpl* jaw_impl_find_instance_by_key(JNIEnv*, jobject, gint);
+JawImpl* jaw_impl_ref_instance_by_key(JNIEnv*, jobject, gint);
+gint jaw_impl_get_object_key(JNIEnv*, jobject);
 GType jaw_impl_get_type (guint);
 
 struct _JawImplClass
@@ -21,6 +21,8 @@
 #include "jawobject.h"
 #include "jawutil.h"
 #include "jawtoplevel.h"
+#include "jawsnapshot.h"
+#include "jawevent.h"
 
 static void			jaw_object_class_init			(JawObjectClass		*klass);
 static void			jaw_object_init				(JawObject		*object);
@@ -177,6 +179,9 @@ jaw_object_init (JawObject *object)
 	atk_obj->description = NULL;
 
 	object->state_set = atk_state_set_new();
+	object->cached_parent = NULL;
+	object->cached_index = -1;
+	object->snapshot = NULL;
 }
 
 static void
@@ -196,24 +201,21 @@ jaw_object_finalize (GObject *gobject)
 	AtkObject *atk_obj = ATK_OBJECT(gobject);
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
-	if (atk_obj->name != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrName, atk_obj->name);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrName);
-		jaw_obj->jstrName = NULL;
-		atk_obj->name = NULL;
-	}
-
-	if (atk_obj->description != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrDescription, atk_obj->description);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrDescription);
-		jaw_obj->jstrDescription = NULL;
-		atk_obj->description = NULL;
-	}
+	// The strings belong to the pool, keep AtkObject from freeing them
+	jaw_string_slot_clear(jniEnv, &jaw_obj->name_slot);
+	jaw_string_slot_clear(jniEnv, &jaw_obj->description_slot);
+	atk_obj->name = NULL;
+	atk_obj->description = NULL;
 
 	if (jaw_obj->state_set != NULL) {
 		g_object_unref(G_OBJECT(jaw_obj->state_set));
 	}
 
+	jaw_object_set_cached_parent(jaw_obj, NULL, -1);
+
+	jaw_snapshot_node_free(jaw_obj->snapshot);
+	jaw_obj->snapshot = NULL;
+
 	/* Chain up to parent's finalize method */
 	G_OBJECT_CLASS(jaw_object_parent_class)->finalize(gobject);
 }
@@ -235,20 +237,19 @@ jaw_object_get_name (AtkObject *atk_obj)
 			}
 		}
 	}
+
+	// The node goes away with the snapshot, the slot keeps its own copy
+	JawSnapshotNode *node = jaw_snapshot_get(jaw_obj);
+	if (node != NULL) {
+		atk_obj->name = (gchar*)jaw_string_slot_set_text(jniEnv, &jaw_obj->name_slot, node->name);
+		return atk_obj->name;
+	}
 	
 	jclass classAccessibleContext = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/AccessibleContext" );
 	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "getAccessibleName", "()Ljava/lang/String;" );
 	jstring jstr = (*jniEnv)->CallObjectMethod( jniEnv, ac, jmid );
 
-	if (atk_obj->name != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrName, atk_obj->name);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrName);
-	}
-
-	if (jstr != NULL) {
-		jaw_obj->jstrName = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-		atk_obj->name = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, jaw_obj->jstrName, NULL);
-	}
+	atk_obj->name = (gchar*)jaw_string_slot_set(jniEnv, &jaw_obj->name_slot, jstr);
 
 	return atk_obj->name;
 }
@@ -264,16 +265,7 @@ jaw_object_get_description (AtkObject *atk_obj)
 	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "getAccessibleDescription", "()Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod( jniEnv, ac, jmid );
 
-	if (atk_obj->description != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, jaw_obj->jstrDescription, atk_obj->description);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, jaw_obj->jstrDescription);
-		atk_obj->description = NULL;
-	}
-
-	if (jstr != NULL) {
-		jaw_obj->jstrDescription = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-		atk_obj->description = (gchar*)(*jniEnv)->GetStringUTFChars( jniEnv, jaw_obj->jstrDescription, NULL);
-	}
+	atk_obj->description = (gchar*)jaw_string_slot_set(jniEnv, &jaw_obj->description_slot, jstr);
 
 	return atk_obj->description;
 }
@@ -282,6 +274,12 @@ static gint
 jaw_object_get_n_children (AtkObject *atk_obj)
 {
 	JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+
+	JawSnapshotNode *node = jaw_snapshot_get(jaw_obj);
+	if (node != NULL) {
+		return node->n_children;
+	}
+
 	jobject ac = jaw_obj->acc_context;
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
@@ -300,6 +298,17 @@ jaw_object_get_index_in_parent (AtkObject *atk_obj)
 	}
 
 	JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+	JawObject *parent = jaw_object_get_cached_parent(jaw_obj);
+	if (parent != NULL && jaw_obj->cached_index >= 0) {
+		return jaw_obj->cached_index;
+	}
+
+	// The snapshot's index went stale along with the cached parent
+	JawSnapshotNode *node = jaw_snapshot_get(jaw_obj);
+	if (node != NULL && (parent != NULL || jaw_obj->cached_parent == NULL)) {
+		return node->index_in_parent;
+	}
+
 	jobject ac = jaw_obj->acc_context;
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
@@ -307,6 +316,10 @@ jaw_object_get_index_in_parent (AtkObject *atk_obj)
 	jmethodID jmid = (*jniEnv)->GetMethodID( jniEnv, classAccessibleContext, "getAccessibleIndexInParent", "()I");
 	jint index = (*jniEnv)->CallIntMethod( jniEnv, ac, jmid );
 
+	if (parent != NULL) {
+		jaw_obj->cached_index = (gint)index;
+	}
+
 	return (gint)index;
 }
 
@@ -314,6 +327,13 @@ static AtkRole
 jaw_object_get_role (AtkObject *atk_obj)
 {
 	JawObject *jaw_obj = JAW_OBJECT(atk_obj);
+
+	JawSnapshotNode *node = jaw_snapshot_get(jaw_obj);
+	if (node != NULL) {
+		atk_obj->role = node->role;
+		return atk_obj->role;
+	}
+
 	atk_obj->role = jaw_util_get_atk_role_from_jobj(jaw_obj->acc_context);
 	return atk_obj->role;
 }
@@ -325,6 +345,19 @@ jaw_object_ref_state_set (AtkObject *atk_obj)
 	AtkStateSet* state_set = jaw_obj->state_set;
 	atk_state_set_clear_states( state_set );
 
+	JawSnapshotNode *node = jaw_snapshot_get(jaw_obj);
+	if (node != NULL) {
+		gint state;
+		for (state = 0; state < 64; state++) {
+			if (node->states & ((guint64)1 << state)) {
+				atk_state_set_add_state( state_set, (AtkStateType)state );
+			}
+		}
+
+		g_object_ref(G_OBJECT(state_set));
+		return state_set;
+	}
+
 	jobject ac = jaw_obj->acc_context;
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 	jclass classAccessibleContext = (*jniEnv)->FindClass( jniEnv, "javax/accessibility/AccessibleContext" );
@@ -351,3 +384,60 @@ jaw_object_ref_state_set (AtkObject *atk_obj)
 	return state_set;
 }
 
+/*
+ * Remembers where the wrapper was found, so that get_parent and
+ * get_index_in_parent do not have to ask Java. The parent is held
+ * weakly, index may be -1 when only the parent is known.
+ */
+void
+jaw_object_set_cached_parent (JawObject *jaw_obj, JawObject *parent, gint index)
+{
+	if (jaw_obj->cached_parent != parent) {
+		if (jaw_obj->cached_parent != NULL) {
+			g_object_remove_weak_pointer(G_OBJECT(jaw_obj->cached_parent),
+					(gpointer*)&jaw_obj->cached_parent);
+		}
+
+		jaw_obj->cached_parent = parent;
+
+		if (parent != NULL) {
+			g_object_add_weak_pointer(G_OBJECT(parent),
+					(gpointer*)&jaw_obj->cached_parent);
+		}
+	}
+
+	jaw_obj->cached_index = index;
+	jaw_obj->cached_generation = (parent != NULL) ? parent->children_generation : 0;
+	jaw_obj->cached_drop_generation = jaw_event_get_drop_generation();
+}
+
+JawObject*
+jaw_object_get_cached_parent (JawObject *jaw_obj)
+{
+	JawObject *parent = jaw_obj->cached_parent;
+
+	// Children were added or removed since, the index may have moved
+	// and the child may be gone from the parent. A dropped event may
+	// have been the one to say so.
+	if (parent == NULL || parent->children_generation != jaw_obj->cached_generation
+			|| jaw_event_get_drop_generation() != jaw_obj->cached_drop_generation) {
+		return NULL;
+	}
+
+	return parent;
+}
+
+// Called before children-changed and model-changed are emitted on jaw_obj
+void
+jaw_object_children_changed (JawObject *jaw_obj)
+{
+	jaw_obj->children_generation++;
+	jaw_obj->content_generation++;
+}
+
+// Called before text-changed is emitted on jaw_obj
+void
+jaw_object_content_changed (JawObject *jaw_obj)
+{
+	jaw_obj->content_generation++;
+}
@@ -22,6 +22,7 @@
 
 #include <atk/atk.h>
 #include <jni.h>
+#include "jawstringpool.h"
 
 G_BEGIN_DECLS
 
@@ -40,11 +41,22 @@ struct _JawObject
 	AtkObject parent;
 	
 	jobject acc_context;
-	jstring jstrName;
-	jstring jstrDescription;
+	JawStringSlot name_slot;
+	JawStringSlot description_slot;
 	AtkStateSet *state_set;
 
-	GHashTable *storedData;
+	// Parent wrapper and index as last seen, valid while the parent's
+	// children_generation still equals cached_generation and no event
+	// was dropped since
+	JawObject *cached_parent;
+	gint cached_index;
+	guint cached_generation;
+	guint cached_drop_generation;
+	guint children_generation;
+	// Bumped when the text changed, see jaw_object_content_changed
+	guint content_generation;
+	// Filled in bulk from a snapshot of the window, see jawsnapshot.h
+	struct _JawSnapshotNode *snapshot;
 };
 
 GType jaw_object_get_type (void);
@@ -57,6 +69,10 @@ struct _JawObjectClass
 };
 
 gpointer jaw_object_get_interface_data (JawObject*, guint);
+void jaw_object_set_cached_parent (JawObject*, JawObject*, gint);
+JawObject* jaw_object_get_cached_parent (JawObject*);
+void jaw_object_children_changed (JawObject*);
+void jaw_object_content_changed (JawObject*);
 
 G_END_DECLS
 
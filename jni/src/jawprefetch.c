@@ -0,0 +1,217 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include "jawprefetch.h"
+#include "jawevent.h"
+
+static gint prefetchDepth = 0;
+static JawPrefetchStats prefetchStats[JAW_PREFETCH_N_KINDS];
+
+static const gchar *kindNames[JAW_PREFETCH_N_KINDS] = {
+	"children",
+	"text",
+	"cells"
+};
+
+void
+jaw_prefetch_init (void)
+{
+	const gchar *depth_env = g_getenv("JAW_PREFETCH_DEPTH");
+	if (depth_env != NULL) {
+		guint64 depth = g_ascii_strtoull(depth_env, NULL, 10);
+		prefetchDepth = (gint)MIN(depth, JAW_PREFETCH_MAX_DEPTH);
+	}
+}
+
+// Spans fetched ahead, 0 when prefetching is off
+gint
+jaw_prefetch_get_depth (void)
+{
+	return prefetchDepth;
+}
+
+JawPrefetch*
+jaw_prefetch_new (JawPrefetchKind kind)
+{
+	JawPrefetch *prefetch = g_new0(JawPrefetch, 1);
+	prefetch->kind = kind;
+	prefetch->next = -1;
+
+	return prefetch;
+}
+
+void
+jaw_prefetch_clear (JNIEnv *jniEnv, JawPrefetch *prefetch)
+{
+	if (prefetch->items != NULL) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, prefetch->items);
+		prefetch->items = NULL;
+	}
+
+	prefetch->start = 0;
+	prefetch->end = 0;
+}
+
+void
+jaw_prefetch_free (JNIEnv *jniEnv, JawPrefetch *prefetch)
+{
+	if (prefetch == NULL) {
+		return;
+	}
+
+	jaw_prefetch_clear(jniEnv, prefetch);
+	g_free(prefetch);
+}
+
+/*
+ * Notes a request for start up to end and returns TRUE if it can be
+ * served from the cache. A cache filled before the object changed, or
+ * too long ago, is dropped.
+ */
+gboolean
+jaw_prefetch_lookup (JNIEnv *jniEnv,
+		JawPrefetch *prefetch,
+		gint line,
+		gint start,
+		gint end,
+		guint generation)
+{
+	JawPrefetchStats *stats = &prefetchStats[prefetch->kind];
+	gboolean sequential = (line == prefetch->line && start == prefetch->next);
+
+	stats->n_requests++;
+
+	prefetch->run = sequential ? prefetch->run + 1 : 1;
+	prefetch->line = line;
+	prefetch->next = end;
+
+	if (prefetch->items == NULL) {
+		return FALSE;
+	}
+
+	// A dropped event may have been the one to bump the generation
+	if (prefetch->generation != generation
+			|| prefetch->drop_generation != jaw_event_get_drop_generation()
+			|| g_get_monotonic_time() > prefetch->expires) {
+		jaw_prefetch_clear(jniEnv, prefetch);
+		return FALSE;
+	}
+
+	if (line != prefetch->items_line || start < prefetch->start || end > prefetch->end) {
+		return FALSE;
+	}
+
+	stats->n_hits++;
+
+	return TRUE;
+}
+
+// After a miss, whether the caller should fetch ahead instead of just this span
+gboolean
+jaw_prefetch_should_fetch (JawPrefetch *prefetch)
+{
+	return prefetchDepth > 0 && prefetch->run >= 2;
+}
+
+void
+jaw_prefetch_store (JNIEnv *jniEnv,
+		JawPrefetch *prefetch,
+		jobject items,
+		gint start,
+		gint end,
+		guint generation)
+{
+	JawPrefetchStats *stats = &prefetchStats[prefetch->kind];
+
+	jaw_prefetch_clear(jniEnv, prefetch);
+
+	if (items == NULL || end <= start) {
+		return;
+	}
+
+	prefetch->items = (*jniEnv)->NewGlobalRef(jniEnv, items);
+	prefetch->items_line = prefetch->line;
+	prefetch->start = start;
+	prefetch->end = end;
+	prefetch->generation = generation;
+	prefetch->drop_generation = jaw_event_get_drop_generation();
+	prefetch->expires = g_get_monotonic_time() + JAW_PREFETCH_TTL_USEC;
+
+	stats->n_batches++;
+	stats->n_prefetched += end - start;
+}
+
+// Local reference to the cached element at pos, for children and cells
+jobject
+jaw_prefetch_get_object (JNIEnv *jniEnv, JawPrefetch *prefetch, gint pos)
+{
+	return (*jniEnv)->GetObjectArrayElement(jniEnv, (jobjectArray)prefetch->items,
+			(jsize)(pos - prefetch->start));
+}
+
+// Cached text from start up to end, newly allocated
+gchar*
+jaw_prefetch_get_text (JNIEnv *jniEnv,
+		JawPrefetch *prefetch,
+		gint start,
+		gint end)
+{
+	jsize len = (jsize)(end - start);
+	jchar *chars = g_new(jchar, len + 1);
+	gchar *text;
+
+	(*jniEnv)->GetStringRegion(jniEnv, (jstring)prefetch->items,
+			(jsize)(start - prefetch->start), len, chars);
+	text = g_utf16_to_utf8((const gunichar2*)chars, len, NULL, NULL, NULL);
+	g_free(chars);
+
+	return text;
+}
+
+void
+jaw_prefetch_get_stats (JawPrefetchKind kind, JawPrefetchStats *stats)
+{
+	*stats = prefetchStats[kind];
+}
+
+void
+jaw_prefetch_dump_stats (void)
+{
+	gint kind;
+
+	if (prefetchDepth == 0) {
+		return;
+	}
+
+	for (kind = 0; kind < JAW_PREFETCH_N_KINDS; kind++) {
+		JawPrefetchStats stats;
+		jaw_prefetch_get_stats(kind, &stats);
+
+		guint64 rate = stats.n_requests > 0
+			? stats.n_hits * 100 / stats.n_requests : 0;
+
+		g_printerr("Prefetch %s: depth %d, %" G_GUINT64_FORMAT " requests, %"
+				G_GUINT64_FORMAT " hits (%" G_GUINT64_FORMAT "%%), %"
+				G_GUINT64_FORMAT " batches, %" G_GUINT64_FORMAT " items prefetched\n",
+				kindNames[kind], prefetchDepth, stats.n_requests,
+				stats.n_hits, rate, stats.n_batches, stats.n_prefetched);
+	}
+}
+
@@ -0,0 +1,98 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_PREFETCH_H_
+#define _JAW_PREFETCH_H_
+
+#include <glib.h>
+#include <jni.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Read-ahead for clients walking children, text or table cells in
+ * order. After two requests in a row for adjacent positions the next
+ * JAW_PREFETCH_DEPTH spans are fetched from Java in one call and
+ * served from native memory until they expire or the object changes.
+ */
+
+// Largest JAW_PREFETCH_DEPTH accepted
+#define JAW_PREFETCH_MAX_DEPTH		256
+
+// Prefetched data is thrown away after this long
+#define JAW_PREFETCH_TTL_USEC		(200 * 1000)
+
+typedef enum _JawPrefetchKind {
+	JAW_PREFETCH_CHILDREN = 0,
+	JAW_PREFETCH_TEXT,
+	JAW_PREFETCH_CELLS,
+	JAW_PREFETCH_N_KINDS
+} JawPrefetchKind;
+
+typedef struct _JawPrefetch {
+	JawPrefetchKind kind;
+	gint line;		// table row of the cells, 0 otherwise
+	gint next;		// where the next request starts if it is sequential
+	gint run;		// sequential requests so far
+	gint items_line;	// cached positions, start up to end of this line
+	gint start;
+	gint end;
+	guint generation;	// of the object when the cache was filled
+	guint drop_generation;	// of the event queue, see jaw_event_get_drop_generation
+	gint64 expires;
+	jobject items;		// global reference, jobjectArray or jstring
+} JawPrefetch;
+
+typedef struct _JawPrefetchStats {
+	guint64 n_requests;
+	guint64 n_hits;
+	guint64 n_batches;
+	guint64 n_prefetched;
+} JawPrefetchStats;
+
+void		jaw_prefetch_init(void);
+gint		jaw_prefetch_get_depth(void);
+JawPrefetch*	jaw_prefetch_new(JawPrefetchKind kind);
+void		jaw_prefetch_free(JNIEnv *jniEnv, JawPrefetch *prefetch);
+void		jaw_prefetch_clear(JNIEnv *jniEnv, JawPrefetch *prefetch);
+gboolean	jaw_prefetch_lookup(JNIEnv *jniEnv,
+			JawPrefetch *prefetch,
+			gint line,
+			gint start,
+			gint end,
+			guint generation);
+gboolean	jaw_prefetch_should_fetch(JawPrefetch *prefetch);
+void		jaw_prefetch_store(JNIEnv *jniEnv,
+			JawPrefetch *prefetch,
+			jobject items,
+			gint start,
+			gint end,
+			guint generation);
+jobject		jaw_prefetch_get_object(JNIEnv *jniEnv, JawPrefetch *prefetch, gint pos);
+gchar*		jaw_prefetch_get_text(JNIEnv *jniEnv,
+			JawPrefetch *prefetch,
+			gint start,
+			gint end);
+void		jaw_prefetch_get_stats(JawPrefetchKind kind, JawPrefetchStats *stats);
+void		jaw_prefetch_dump_stats(void);
+
+G_END_DECLS
+
+#endif
+
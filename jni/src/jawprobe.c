@@ -0,0 +1,85 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Small probe library loaded by AtkWrapper before the main library.
+ * It only links against Xlib so that deciding whether accessibility
+ * is enabled does not pull in GLib, ATK or GDK.
+ */
+
+#include <jni.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+
+static int
+jaw_probe_root_property (Display *display, const char *name)
+{
+	Atom atom;
+	Atom actual_type = None;
+	int actual_format;
+	unsigned long n_items;
+	unsigned long bytes_after;
+	unsigned char *data = NULL;
+
+	// Nobody ever set the property if the atom does not exist yet
+	atom = XInternAtom(display, name, True);
+	if (atom == None) {
+		return 0;
+	}
+
+	if (XGetWindowProperty(display, DefaultRootWindow(display), atom,
+				0, 0, False, AnyPropertyType,
+				&actual_type, &actual_format,
+				&n_items, &bytes_after, &data) != Success) {
+		return 0;
+	}
+
+	if (data != NULL) {
+		XFree(data);
+	}
+
+	return actual_type != None;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_GNOME_Accessibility_AtkWrapper_probeAccessibility(JNIEnv *jniEnv, jclass jClass) {
+	Display *display;
+	int enabled;
+
+	// GNOME_ACCESSIBILITY=1 or 0 forces the result either way
+	const char *env = getenv("GNOME_ACCESSIBILITY");
+	if (env != NULL && strcmp(env, "1") == 0) {
+		return JNI_TRUE;
+	}
+	if (env != NULL && strcmp(env, "0") == 0) {
+		return JNI_FALSE;
+	}
+
+	display = XOpenDisplay(NULL);
+	if (display == NULL) {
+		return JNI_FALSE;
+	}
+
+	enabled = jaw_probe_root_property(display, "AT_SPI_IOR");
+
+	XCloseDisplay(display);
+
+	return enabled ? JNI_TRUE : JNI_FALSE;
+}
+
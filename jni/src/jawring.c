@@ -0,0 +1,245 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <glib.h>
+#include "jawring.h"
+#include "jawevent.h"
+#include "jawutil.h"
+
+/*
+ * Optional event transport, enabled with JAW_EVENT_RING. Java writes
+ * fixed size records into native memory it sees as a direct ByteBuffer
+ * and only calls into native code when the consumer asked to be woken
+ * up, or to flush a full ring. Object references stay in a Java array
+ * with one pair of slots per record, most records are resolved by
+ * their identity key without touching it.
+ *
+ * Java is the only writer of head, the consumer the only writer of
+ * tail. The consumer sets wakeup before it goes idle and checks head
+ * once more afterwards, Java checks wakeup after publishing head.
+ */
+
+static guchar *ringMemory = NULL;
+static guint ringCapacity = 0;
+static jobjectArray ringSlots = NULL;
+static JawRingConsumeFunc ringConsume = NULL;
+static GMutex *ringMutex = NULL;
+static JawRingStats ringStats;
+
+#define RING_INT(offset)	((volatile gint*)(ringMemory + (offset)))
+
+void
+jaw_ring_init (JawRingConsumeFunc consume)
+{
+	guint64 size;
+
+	const gchar *ring_env = g_getenv("JAW_EVENT_RING");
+	if (ring_env == NULL) {
+		return;
+	}
+
+	size = g_ascii_strtoull(ring_env, NULL, 10);
+	if (size == 0) {
+		return;
+	}
+
+	if (size == 1) {
+		size = JAW_RING_SIZE;
+	}
+	size = CLAMP(size, JAW_RING_MIN_SIZE, JAW_RING_MAX_SIZE);
+
+	// Indexes are masked, round up to a power of two
+	ringCapacity = 1;
+	while (ringCapacity < size) {
+		ringCapacity <<= 1;
+	}
+
+	ringMemory = g_malloc0(JAW_RING_HEADER_SIZE + ringCapacity * JAW_RING_RECORD_SIZE);
+	*RING_INT(JAW_RING_CAPACITY_OFFSET) = (gint)ringCapacity;
+	// Nothing drains yet, the first record has to schedule it
+	*RING_INT(JAW_RING_WAKEUP_OFFSET) = 1;
+
+	ringConsume = consume;
+	ringMutex = g_mutex_new();
+	ringStats.capacity = ringCapacity;
+}
+
+gboolean
+jaw_ring_is_enabled (void)
+{
+	return ringMemory != NULL;
+}
+
+jobject
+jaw_ring_get_slot (JNIEnv *jniEnv, guint slot, guint n)
+{
+	return (*jniEnv)->GetObjectArrayElement(jniEnv, ringSlots, (jsize)(slot * 2 + n));
+}
+
+// Called with ringMutex held, returns FALSE once the ring is empty
+static gboolean
+drain_records (JNIEnv *jniEnv, guint max)
+{
+	guint tail = (guint)g_atomic_int_get(RING_INT(JAW_RING_TAIL_OFFSET));
+	guint n;
+
+	ringStats.n_drains++;
+
+	for (n = 0; n < max; n++) {
+		JawRingRecord record;
+		guint head = (guint)g_atomic_int_get(RING_INT(JAW_RING_HEAD_OFFSET));
+
+		if (head == tail) {
+			return FALSE;
+		}
+
+		guint slot = tail & (ringCapacity - 1);
+		memcpy(&record, ringMemory + JAW_RING_HEADER_SIZE + slot * JAW_RING_RECORD_SIZE,
+				sizeof(JawRingRecord));
+		ringConsume(jniEnv, &record, slot);
+
+		// Do not keep the objects alive until the record is reused
+		(*jniEnv)->SetObjectArrayElement(jniEnv, ringSlots, (jsize)(slot * 2), NULL);
+		(*jniEnv)->SetObjectArrayElement(jniEnv, ringSlots, (jsize)(slot * 2 + 1), NULL);
+
+		// Java may reuse the record and its slots from now on
+		tail++;
+		g_atomic_int_set(RING_INT(JAW_RING_TAIL_OFFSET), (gint)tail);
+		ringStats.n_records++;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+drain_ring (gpointer p)
+{
+	JNIEnv *jniEnv = jaw_util_get_jni_env();
+	gboolean more;
+
+	g_mutex_lock(ringMutex);
+	more = drain_records(jniEnv, JAW_RING_BATCH_SIZE);
+	if (!more) {
+		g_atomic_int_set(RING_INT(JAW_RING_WAKEUP_OFFSET), 1);
+
+		// A record published before the flag was seen would be stranded
+		guint head = (guint)g_atomic_int_get(RING_INT(JAW_RING_HEAD_OFFSET));
+		guint tail = (guint)g_atomic_int_get(RING_INT(JAW_RING_TAIL_OFFSET));
+		if (head != tail) {
+			// Unless Java already took the flag and scheduled us again
+			more = g_atomic_int_compare_and_exchange(RING_INT(JAW_RING_WAKEUP_OFFSET), 1, 0);
+		}
+	}
+	g_mutex_unlock(ringMutex);
+
+	return more;
+}
+
+/*
+ * Events that bypass the ring would overtake the records still in it,
+ * move those to the event queue first. Called on the posting thread.
+ */
+void
+jaw_ring_sync (JNIEnv *jniEnv)
+{
+	if (!jaw_ring_is_enabled()) {
+		return;
+	}
+
+	if (g_atomic_int_get(RING_INT(JAW_RING_HEAD_OFFSET))
+			== g_atomic_int_get(RING_INT(JAW_RING_TAIL_OFFSET))) {
+		return;
+	}
+
+	g_mutex_lock(ringMutex);
+	ringStats.n_syncs++;
+	while (drain_records(jniEnv, ringCapacity)) {
+	}
+	g_mutex_unlock(ringMutex);
+}
+
+void
+jaw_ring_get_stats (JawRingStats *stats)
+{
+	if (ringMutex == NULL) {
+		memset(stats, 0, sizeof(JawRingStats));
+		return;
+	}
+
+	g_mutex_lock(ringMutex);
+	*stats = ringStats;
+	g_mutex_unlock(ringMutex);
+}
+
+void
+jaw_ring_dump_stats (void)
+{
+	JawRingStats stats;
+
+	if (!jaw_ring_is_enabled()) {
+		return;
+	}
+
+	jaw_ring_get_stats(&stats);
+	g_printerr("Event ring: %u records, %" G_GUINT64_FORMAT " consumed in %"
+			G_GUINT64_FORMAT " drains, %" G_GUINT64_FORMAT " wakeups, %"
+			G_GUINT64_FORMAT " flushes, %" G_GUINT64_FORMAT " syncs\n",
+			stats.capacity, stats.n_records, stats.n_drains,
+			stats.n_wakeups, stats.n_flushes, stats.n_syncs);
+}
+
+JNIEXPORT jobject JNICALL Java_org_GNOME_Accessibility_AtkEventRing_createBuffer(JNIEnv *jniEnv, jclass jClass) {
+	if (!jaw_ring_is_enabled()) {
+		return NULL;
+	}
+
+	return (*jniEnv)->NewDirectByteBuffer(jniEnv, ringMemory,
+			(jlong)(JAW_RING_HEADER_SIZE + ringCapacity * JAW_RING_RECORD_SIZE));
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkEventRing_setSlots(JNIEnv *jniEnv, jclass jClass, jobjectArray slots) {
+	g_mutex_lock(ringMutex);
+	if (ringSlots != NULL) {
+		(*jniEnv)->DeleteGlobalRef(jniEnv, ringSlots);
+	}
+	ringSlots = (*jniEnv)->NewGlobalRef(jniEnv, slots);
+	g_mutex_unlock(ringMutex);
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkEventRing_wakeup(JNIEnv *jniEnv, jclass jClass) {
+	// Several producers may see the flag, only one schedules the drain
+	if (g_atomic_int_compare_and_exchange(RING_INT(JAW_RING_WAKEUP_OFFSET), 1, 0)) {
+		g_mutex_lock(ringMutex);
+		ringStats.n_wakeups++;
+		g_mutex_unlock(ringMutex);
+
+		jaw_event_idle_add(drain_ring, NULL);
+	}
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkEventRing_flush(JNIEnv *jniEnv, jclass jClass) {
+	// The ring is full, move everything to the event queue from this thread
+	g_mutex_lock(ringMutex);
+	ringStats.n_flushes++;
+	while (drain_records(jniEnv, ringCapacity)) {
+	}
+	g_mutex_unlock(ringMutex);
+}
+
@@ -0,0 +1,86 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_RING_H_
+#define _JAW_RING_H_
+
+#include <glib.h>
+#include <jni.h>
+
+G_BEGIN_DECLS
+
+// Records in the ring when JAW_EVENT_RING=1, a larger value sets the size
+#define JAW_RING_SIZE			1024
+#define JAW_RING_MIN_SIZE		64
+#define JAW_RING_MAX_SIZE		(1 << 20)
+
+// Records handed to the event queue per main loop iteration
+#define JAW_RING_BATCH_SIZE		64
+
+// Layout shared with AtkEventRing.java, head, tail and wakeup
+// each sit on their own cache line
+#define JAW_RING_HEAD_OFFSET		0
+#define JAW_RING_CAPACITY_OFFSET	4
+#define JAW_RING_TAIL_OFFSET		64
+#define JAW_RING_WAKEUP_OFFSET		128
+#define JAW_RING_HEADER_SIZE		192
+#define JAW_RING_RECORD_SIZE		32
+
+typedef enum _JawRingKind {
+	JAW_RING_SIGNAL = 0,		// emitSignal and emitSignalII
+	JAW_RING_SIGNAL_OBJ,		// emitSignalObj, the child is in the second slot
+	JAW_RING_STATE_CHANGE		// objectStateChange, the state is in the second slot
+} JawRingKind;
+
+// One record as written by Java, in native byte order
+typedef struct _JawRingRecord {
+	gint kind;
+	gint id;
+	gint key;
+	gint arg1;
+	gint arg2;
+	gint extra_key;
+	gint64 when;
+} JawRingRecord;
+
+typedef struct _JawRingStats {
+	guint capacity;
+	guint64 n_records;
+	guint64 n_drains;
+	guint64 n_wakeups;
+	guint64 n_flushes;
+	guint64 n_syncs;
+} JawRingStats;
+
+// Called for each record, slot indexes the Java object table
+typedef void (*JawRingConsumeFunc) (JNIEnv *jniEnv,
+		const JawRingRecord *record,
+		guint slot);
+
+void		jaw_ring_init(JawRingConsumeFunc consume);
+gboolean	jaw_ring_is_enabled(void);
+jobject		jaw_ring_get_slot(JNIEnv *jniEnv, guint slot, guint n);
+void		jaw_ring_sync(JNIEnv *jniEnv);
+void		jaw_ring_get_stats(JawRingStats *stats);
+void		jaw_ring_dump_stats(void);
+
+G_END_DECLS
+
+#endif
+
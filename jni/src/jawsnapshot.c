@@ -0,0 +1,504 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <glib.h>
+#include "jawsnapshot.h"
+#include "jawimpl.h"
+#include "jawutil.h"
+#include "jawevent.h"
+#include "jawring.h"
+
+/*
+ * Optional bulk cache fill, enabled with JAW_SNAPSHOT. The first time
+ * a window's children are asked for, AtkSnapshot walks its subtree on
+ * the event dispatch thread and hands back role, states, child count,
+ * bounds and name of every node in one buffer. Wrappers that exist get
+ * their node right away, the others when they are created.
+ *
+ * The walk is only requested, the main loop never waits for it: the
+ * event dispatch thread may be waiting for the loop itself, in
+ * dispatchKeyEvent for one. The result comes back as an event, queued
+ * behind what the tree sent before the walk, and is read on the loop
+ * thread. Until then the wrappers ask Java as usual.
+ *
+ * A node is dropped as soon as an event arrives for its object. Java
+ * sends state, name and children changes of snapshotted contexts even
+ * if nobody listens, see AtkSnapshot.isSnapshotted. Bounds have no
+ * events, so a node is trusted for JAW_SNAPSHOT_TTL_USEC at most.
+ */
+
+static guint snapshotMaxNodes = 0;
+static GMutex *pendingMutex = NULL;
+static GHashTable *pendingNodes = NULL;	// key -> JawSnapshotNode of objects without a wrapper
+static JawSnapshotStats snapshotStats;
+
+typedef struct _SnapshotReader {
+	const guchar *data;
+	gsize len;
+	gsize pos;
+	gboolean error;
+} SnapshotReader;
+
+void
+jaw_snapshot_init (void)
+{
+	guint64 n;
+
+	const gchar *snapshot_env = g_getenv("JAW_SNAPSHOT");
+	if (snapshot_env == NULL) {
+		return;
+	}
+
+	n = g_ascii_strtoull(snapshot_env, NULL, 10);
+	if (n == 0) {
+		return;
+	}
+
+	if (n == 1) {
+		n = JAW_SNAPSHOT_MAX_NODES;
+	}
+	snapshotMaxNodes = (guint)MIN(n, G_MAXINT);
+
+	pendingMutex = g_mutex_new();
+	pendingNodes = g_hash_table_new_full(NULL, NULL, NULL,
+			(GDestroyNotify)jaw_snapshot_node_free);
+}
+
+gboolean
+jaw_snapshot_is_enabled (void)
+{
+	return snapshotMaxNodes > 0;
+}
+
+void
+jaw_snapshot_node_free (JawSnapshotNode *node)
+{
+	if (node == NULL) {
+		return;
+	}
+
+	if (node->context != NULL) {
+		JNIEnv *jniEnv = jaw_util_get_jni_env();
+		(*jniEnv)->DeleteWeakGlobalRef(jniEnv, node->context);
+	}
+
+	g_free(node->name);
+	g_free(node);
+}
+
+static void
+set_node (JawObject *jaw_obj, JawSnapshotNode *node)
+{
+	jaw_snapshot_node_free(jaw_obj->snapshot);
+	jaw_obj->snapshot = node;
+}
+
+// The node of jaw_obj if it is still fresh
+JawSnapshotNode*
+jaw_snapshot_get (JawObject *jaw_obj)
+{
+	JawSnapshotNode *node = jaw_obj->snapshot;
+
+	if (node == NULL || !node->loaded) {
+		return NULL;
+	}
+
+	if (g_get_monotonic_time() > node->expires) {
+		set_node(jaw_obj, NULL);
+		return NULL;
+	}
+
+	snapshotStats.n_hits++;
+
+	return node;
+}
+
+static guint32
+read_uint32 (SnapshotReader *reader)
+{
+	guint32 value;
+
+	if (reader->error || reader->len - reader->pos < sizeof(value)) {
+		reader->error = TRUE;
+		return 0;
+	}
+
+	memcpy(&value, reader->data + reader->pos, sizeof(value));
+	reader->pos += sizeof(value);
+
+	return GUINT32_FROM_BE(value);
+}
+
+static gint
+read_int (SnapshotReader *reader)
+{
+	return (gint)read_uint32(reader);
+}
+
+static guint
+read_short (SnapshotReader *reader)
+{
+	guint16 value;
+
+	if (reader->error || reader->len - reader->pos < sizeof(value)) {
+		reader->error = TRUE;
+		return 0;
+	}
+
+	memcpy(&value, reader->data + reader->pos, sizeof(value));
+	reader->pos += sizeof(value);
+
+	return GUINT16_FROM_BE(value);
+}
+
+static guint64
+read_long (SnapshotReader *reader)
+{
+	guint64 high = read_uint32(reader);
+	guint64 low = read_uint32(reader);
+
+	return (high << 32) | low;
+}
+
+static gchar*
+read_string (SnapshotReader *reader)
+{
+	gint len = read_int(reader);
+
+	if (reader->error || len < 0) {
+		return NULL;
+	}
+
+	if (reader->len - reader->pos < (gsize)len) {
+		reader->error = TRUE;
+		return NULL;
+	}
+
+	gchar *str = g_strndup((const gchar*)reader->data + reader->pos, len);
+	reader->pos += len;
+
+	return str;
+}
+
+static gboolean
+is_expired (gpointer key, gpointer value, gpointer data)
+{
+	JawSnapshotNode *node = (JawSnapshotNode*)value;
+	return node->expires < *(gint64*)data;
+}
+
+static jobject
+get_snapshot_field (JNIEnv *jniEnv, jclass classSnapshot, jobject jsnapshot,
+		const gchar *name, const gchar *sig)
+{
+	jfieldID jfid = (*jniEnv)->GetFieldID(jniEnv, classSnapshot, name, sig);
+	return (*jniEnv)->GetObjectField(jniEnv, jsnapshot, jfid);
+}
+
+static void
+read_nodes (JNIEnv *jniEnv, SnapshotReader *reader, jobjectArray jcontexts,
+		const AtkRole *roles, jsize n_roles,
+		const AtkStateType *states, jsize n_states)
+{
+	gint n, i;
+	JawObject **objects;
+	gint64 expires = g_get_monotonic_time() + JAW_SNAPSHOT_TTL_USEC;
+
+	if (read_int(reader) != JAW_SNAPSHOT_MAGIC
+			|| read_int(reader) != JAW_SNAPSHOT_VERSION) {
+		return;
+	}
+
+	n = read_int(reader);
+	if (reader->error || n < 0 || n > (gint)snapshotMaxNodes
+			|| n > (gint)(*jniEnv)->GetArrayLength(jniEnv, jcontexts)) {
+		return;
+	}
+
+	// Wrappers found so far by node number, for the cached parents
+	objects = g_new0(JawObject*, n);
+
+	for (i = 0; i < n; i++) {
+		JawSnapshotNode *node = g_new0(JawSnapshotNode, 1);
+		gint key = read_int(reader);
+		gint parent = read_int(reader);
+		guint role = 0;
+		guint64 mask;
+		jsize bit;
+
+		node->index_in_parent = read_int(reader);
+		role = read_short(reader);
+		mask = read_long(reader);
+		node->n_children = read_int(reader);
+		node->x = read_int(reader);
+		node->y = read_int(reader);
+		node->width = read_int(reader);
+		node->height = read_int(reader);
+		node->name = read_string(reader);
+
+		if (reader->error) {
+			jaw_snapshot_node_free(node);
+			break;
+		}
+
+		node->loaded = TRUE;
+		node->expires = expires;
+		node->role = (role < (guint)n_roles) ? roles[role] : ATK_ROLE_UNKNOWN;
+		node->has_bounds = (node->x != JAW_SNAPSHOT_NO_BOUNDS);
+
+		for (bit = 0; bit < n_states; bit++) {
+			if ((mask & ((guint64)1 << bit)) && states[bit] < 64) {
+				node->states |= (guint64)1 << states[bit];
+				// Same as jaw_object_ref_state_set
+				if (states[bit] == ATK_STATE_ENABLED) {
+					node->states |= (guint64)1 << ATK_STATE_SENSITIVE;
+				}
+			}
+		}
+
+		snapshotStats.n_nodes++;
+
+		jobject ac = (*jniEnv)->GetObjectArrayElement(jniEnv, jcontexts, i);
+		JawImpl *jaw_impl = jaw_impl_find_instance_by_key(jniEnv, ac, key);
+		if (jaw_impl == NULL) {
+			// Another context may get a wrapper under the same key first
+			node->context = (*jniEnv)->NewWeakGlobalRef(jniEnv, ac);
+		}
+		(*jniEnv)->DeleteLocalRef(jniEnv, ac);
+		if (jaw_impl != NULL) {
+			JawObject *jaw_obj = JAW_OBJECT(jaw_impl);
+			set_node(jaw_obj, node);
+			snapshotStats.n_applied++;
+
+			objects[i] = jaw_obj;
+			if (parent >= 0 && parent < i && objects[parent] != NULL) {
+				jaw_object_set_cached_parent(jaw_obj, objects[parent], node->index_in_parent);
+			}
+		} else {
+			g_mutex_lock(pendingMutex);
+			g_hash_table_replace(pendingNodes, GINT_TO_POINTER(key), node);
+			g_mutex_unlock(pendingMutex);
+		}
+	}
+
+	g_free(objects);
+}
+
+typedef struct _SnapshotLoad {
+	jobject global_snapshot;
+} SnapshotLoad;
+
+static void
+free_snapshot_load (gpointer p)
+{
+	SnapshotLoad *load = (SnapshotLoad*)p;
+	JNIEnv *jniEnv = jaw_util_get_jni_env();
+
+	(*jniEnv)->DeleteGlobalRef(jniEnv, load->global_snapshot);
+	g_free(load);
+}
+
+static gboolean
+load_snapshot_handler (gpointer p)
+{
+	SnapshotLoad *load = (SnapshotLoad*)p;
+	JNIEnv *jniEnv = jaw_util_get_jni_env();
+	jobject jsnapshot = load->global_snapshot;
+	jsize i;
+	gint64 now = g_get_monotonic_time();
+
+	snapshotStats.n_loads++;
+
+	g_mutex_lock(pendingMutex);
+	g_hash_table_foreach_remove(pendingNodes, is_expired, &now);
+	g_mutex_unlock(pendingMutex);
+
+	jclass classSnapshot = (*jniEnv)->GetObjectClass(jniEnv, jsnapshot);
+	jbyteArray jdata = get_snapshot_field(jniEnv, classSnapshot, jsnapshot, "data", "[B");
+	jobjectArray jroles = get_snapshot_field(jniEnv, classSnapshot, jsnapshot, "roles", "[Ljava/lang/Object;");
+	jobjectArray jstates = get_snapshot_field(jniEnv, classSnapshot, jsnapshot, "states", "[Ljava/lang/Object;");
+	jobjectArray jcontexts = get_snapshot_field(jniEnv, classSnapshot, jsnapshot, "contexts", "[Ljava/lang/Object;");
+
+	// The slow role and state lookups run once per distinct value
+	jsize n_roles = (*jniEnv)->GetArrayLength(jniEnv, jroles);
+	AtkRole *roles = g_new(AtkRole, n_roles + 1);
+	for (i = 0; i < n_roles; i++) {
+		jobject jrole_ac = (*jniEnv)->GetObjectArrayElement(jniEnv, jroles, i);
+		roles[i] = jaw_util_get_atk_role_from_jobj(jrole_ac);
+		(*jniEnv)->DeleteLocalRef(jniEnv, jrole_ac);
+	}
+
+	jsize n_states = (*jniEnv)->GetArrayLength(jniEnv, jstates);
+	AtkStateType *states = g_new(AtkStateType, n_states + 1);
+	for (i = 0; i < n_states; i++) {
+		jobject jstate = (*jniEnv)->GetObjectArrayElement(jniEnv, jstates, i);
+		states[i] = jaw_util_get_atk_state_type_from_java_state(jniEnv, jstate);
+		(*jniEnv)->DeleteLocalRef(jniEnv, jstate);
+	}
+
+	SnapshotReader reader;
+	reader.len = (gsize)(*jniEnv)->GetArrayLength(jniEnv, jdata);
+	reader.data = g_malloc(reader.len);
+	reader.pos = 0;
+	reader.error = FALSE;
+	(*jniEnv)->GetByteArrayRegion(jniEnv, jdata, 0, (jsize)reader.len, (jbyte*)reader.data);
+
+	read_nodes(jniEnv, &reader, jcontexts, roles, n_roles, states, n_states);
+
+	g_free((gpointer)reader.data);
+	g_free(roles);
+	g_free(states);
+
+	free_snapshot_load(load);
+
+	return FALSE;
+}
+
+// Called when the children of a window are asked for
+void
+jaw_snapshot_ensure (JNIEnv *jniEnv, JawObject *window)
+{
+	JawSnapshotNode *node = window->snapshot;
+
+	if (!jaw_snapshot_is_enabled()) {
+		return;
+	}
+
+	// Taken a short while ago, or still on its way
+	if (node != NULL && g_get_monotonic_time() <= node->expires) {
+		return;
+	}
+
+	snapshotStats.n_requests++;
+
+	jclass classSnapshot = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkSnapshot");
+	jmethodID jmid = (*jniEnv)->GetStaticMethodID(jniEnv, classSnapshot, "request", "(Ljavax/accessibility/AccessibleContext;II)V");
+	(*jniEnv)->CallStaticVoidMethod(jniEnv, classSnapshot, jmid,
+			window->acc_context, (jint)((JawImpl*)window)->hash_key, (jint)snapshotMaxNodes);
+
+	// Nothing is known yet, keeps us from asking again meanwhile
+	node = g_new0(JawSnapshotNode, 1);
+	node->loaded = FALSE;
+	node->expires = g_get_monotonic_time() + JAW_SNAPSHOT_TTL_USEC;
+	set_node(window, node);
+}
+
+JNIEXPORT void JNICALL Java_org_GNOME_Accessibility_AtkSnapshot_snapshotReady(
+		JNIEnv *jniEnv, jclass jClass, jint jKey, jobject jSnapshot) {
+	if (!jaw_snapshot_is_enabled()) {
+		return;
+	}
+
+	SnapshotLoad *load = g_new(SnapshotLoad, 1);
+	load->global_snapshot = (*jniEnv)->NewGlobalRef(jniEnv, jSnapshot);
+
+	// Behind every event sent before the walk, and in the focus lane so
+	// nothing sent after it gets there first
+	jaw_ring_sync(jniEnv);
+	jaw_event_post_compactable(JAW_EVENT_LANE_FOCUS,
+			load_snapshot_handler,
+			load,
+			free_snapshot_load,
+			jKey,
+			0,
+			NULL);
+}
+
+// A wrapper was created for key, give it what the last snapshot knew
+void
+jaw_snapshot_take_pending (JawObject *jaw_obj, gint key)
+{
+	JawSnapshotNode *node = NULL;
+
+	if (!jaw_snapshot_is_enabled()) {
+		return;
+	}
+
+	JNIEnv *jniEnv = jaw_util_get_jni_env();
+
+	g_mutex_lock(pendingMutex);
+	node = (JawSnapshotNode*)g_hash_table_lookup(pendingNodes, GINT_TO_POINTER(key));
+	// Keys are identity hashes, the node may belong to another context
+	if (node != NULL && !(*jniEnv)->IsSameObject(jniEnv, node->context, jaw_obj->acc_context)) {
+		node = NULL;
+	}
+	if (node != NULL) {
+		g_hash_table_steal(pendingNodes, GINT_TO_POINTER(key));
+	}
+	g_mutex_unlock(pendingMutex);
+
+	if (node != NULL) {
+		(*jniEnv)->DeleteWeakGlobalRef(jniEnv, node->context);
+		node->context = NULL;
+		set_node(jaw_obj, node);
+		snapshotStats.n_adopted++;
+	}
+}
+
+// An event arrived for the object, what the snapshot says may be wrong now
+void
+jaw_snapshot_invalidate (JawObject *jaw_obj, gint key)
+{
+	if (!jaw_snapshot_is_enabled()) {
+		return;
+	}
+
+	if (jaw_obj != NULL && jaw_obj->snapshot != NULL && jaw_obj->snapshot->loaded) {
+		set_node(jaw_obj, NULL);
+		snapshotStats.n_invalidated++;
+	}
+
+	g_mutex_lock(pendingMutex);
+	if (g_hash_table_remove(pendingNodes, GINT_TO_POINTER(key))) {
+		snapshotStats.n_invalidated++;
+	}
+	g_mutex_unlock(pendingMutex);
+}
+
+void
+jaw_snapshot_get_stats (JawSnapshotStats *stats)
+{
+	*stats = snapshotStats;
+}
+
+void
+jaw_snapshot_dump_stats (void)
+{
+	JawSnapshotStats stats;
+	guint n_pending = 0;
+
+	if (!jaw_snapshot_is_enabled()) {
+		return;
+	}
+
+	jaw_snapshot_get_stats(&stats);
+
+	g_mutex_lock(pendingMutex);
+	n_pending = g_hash_table_size(pendingNodes);
+	g_mutex_unlock(pendingMutex);
+
+	g_printerr("Snapshots: %" G_GUINT64_FORMAT " requests, %" G_GUINT64_FORMAT
+			" loads, %" G_GUINT64_FORMAT " nodes, %" G_GUINT64_FORMAT
+			" applied, %" G_GUINT64_FORMAT " adopted, %u pending, %"
+			G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " invalidated\n",
+			stats.n_requests, stats.n_loads, stats.n_nodes, stats.n_applied,
+			stats.n_adopted, n_pending, stats.n_hits, stats.n_invalidated);
+}
+
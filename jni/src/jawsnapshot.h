@@ -0,0 +1,78 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_SNAPSHOT_H_
+#define _JAW_SNAPSHOT_H_
+
+#include "jawobject.h"
+
+G_BEGIN_DECLS
+
+// Nodes read per window when JAW_SNAPSHOT=1, a larger value sets the limit
+#define JAW_SNAPSHOT_MAX_NODES		4096
+
+// A snapshot is trusted this long unless an event for the object arrives
+#define JAW_SNAPSHOT_TTL_USEC		(1000 * 1000)
+
+// Layout written by AtkSnapshot.java, big endian
+#define JAW_SNAPSHOT_MAGIC		0x4a415753
+#define JAW_SNAPSHOT_VERSION		1
+#define JAW_SNAPSHOT_NO_BOUNDS		G_MININT32
+
+// What one node of the tree looked like when the snapshot was taken
+typedef struct _JawSnapshotNode {
+	gint64 expires;
+	gboolean loaded;	// FALSE marks a failed attempt, nothing is known
+	AtkRole role;
+	guint64 states;		// one bit per AtkStateType
+	gint n_children;
+	gint index_in_parent;
+	gboolean has_bounds;
+	gint x;
+	gint y;
+	gint width;
+	gint height;
+	gchar *name;
+	jweak context;		// set while the node waits for its wrapper
+} JawSnapshotNode;
+
+typedef struct _JawSnapshotStats {
+	guint64 n_requests;
+	guint64 n_loads;
+	guint64 n_nodes;
+	guint64 n_applied;
+	guint64 n_adopted;
+	guint64 n_hits;
+	guint64 n_invalidated;
+} JawSnapshotStats;
+
+void			jaw_snapshot_init(void);
+gboolean		jaw_snapshot_is_enabled(void);
+void			jaw_snapshot_ensure(JNIEnv *jniEnv, JawObject *window);
+JawSnapshotNode*	jaw_snapshot_get(JawObject *jaw_obj);
+void			jaw_snapshot_take_pending(JawObject *jaw_obj, gint key);
+void			jaw_snapshot_invalidate(JawObject *jaw_obj, gint key);
+void			jaw_snapshot_node_free(JawSnapshotNode *node);
+void			jaw_snapshot_get_stats(JawSnapshotStats *stats);
+void			jaw_snapshot_dump_stats(void);
+
+G_END_DECLS
+
+#endif
+
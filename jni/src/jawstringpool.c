@@ -0,0 +1,200 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+#include <glib.h>
+#include "jawstringpool.h"
+
+typedef struct _JawStringEntry {
+	gint ref_count;
+	gsize length;
+	gchar str[1];
+} JawStringEntry;
+
+#define JAW_STRING_ENTRY(s)	((JawStringEntry*)((s) - G_STRUCT_OFFSET(JawStringEntry, str)))
+
+static GHashTable *stringTable = NULL;
+static GMutex *stringTableMutex = NULL;
+static JawStringPoolStats poolStats;
+
+void
+jaw_string_pool_init (void)
+{
+	if (stringTableMutex == NULL) {
+		stringTableMutex = g_mutex_new();
+	}
+
+	g_mutex_lock(stringTableMutex);
+	if (stringTable == NULL) {
+		stringTable = g_hash_table_new(g_str_hash, g_str_equal);
+	}
+	g_mutex_unlock(stringTableMutex);
+}
+
+const gchar*
+jaw_string_pool_intern (const gchar *str)
+{
+	JawStringEntry *entry;
+
+	if (str == NULL) {
+		return NULL;
+	}
+
+	g_mutex_lock(stringTableMutex);
+	poolStats.n_lookups++;
+
+	entry = (JawStringEntry*)g_hash_table_lookup(stringTable, str);
+	if (entry != NULL) {
+		entry->ref_count++;
+		poolStats.n_hits++;
+		poolStats.bytes_shared += entry->length + 1;
+	} else {
+		gsize length = strlen(str);
+		entry = (JawStringEntry*)g_malloc(G_STRUCT_OFFSET(JawStringEntry, str) + length + 1);
+		entry->ref_count = 1;
+		entry->length = length;
+		memcpy(entry->str, str, length + 1);
+		g_hash_table_insert(stringTable, entry->str, entry);
+		poolStats.n_strings++;
+		poolStats.bytes_used += length + 1;
+	}
+
+	poolStats.n_refs++;
+	g_mutex_unlock(stringTableMutex);
+
+	return entry->str;
+}
+
+void
+jaw_string_pool_release (const gchar *str)
+{
+	JawStringEntry *entry;
+
+	if (str == NULL) {
+		return;
+	}
+
+	entry = JAW_STRING_ENTRY(str);
+
+	g_mutex_lock(stringTableMutex);
+	poolStats.n_refs--;
+	entry->ref_count--;
+	if (entry->ref_count == 0) {
+		g_hash_table_remove(stringTable, entry->str);
+		poolStats.n_strings--;
+		poolStats.bytes_used -= entry->length + 1;
+		g_free(entry);
+	} else {
+		poolStats.bytes_shared -= entry->length + 1;
+	}
+	g_mutex_unlock(stringTableMutex);
+}
+
+void
+jaw_string_pool_get_stats (JawStringPoolStats *stats)
+{
+	g_mutex_lock(stringTableMutex);
+	*stats = poolStats;
+	g_mutex_unlock(stringTableMutex);
+}
+
+void
+jaw_string_pool_dump_stats (void)
+{
+	JawStringPoolStats stats;
+	jaw_string_pool_get_stats(&stats);
+
+	g_printerr("String pool: %u strings, %u refs, %lu bytes used, %lu bytes shared\n",
+			stats.n_strings, stats.n_refs,
+			(gulong)stats.bytes_used, (gulong)stats.bytes_shared);
+	g_printerr("String pool: %" G_GUINT64_FORMAT " lookups, %" G_GUINT64_FORMAT " hits, %"
+			G_GUINT64_FORMAT " unchanged strings reused\n",
+			stats.n_lookups, stats.n_hits, stats.n_reuses);
+}
+
+const gchar*
+jaw_string_slot_set (JNIEnv *jniEnv, JawStringSlot *slot, jstring jstr)
+{
+	if (jstr == NULL) {
+		jaw_string_slot_clear(jniEnv, slot);
+		return NULL;
+	}
+
+	// Java strings are immutable, the same object always has the same text
+	if (slot->str != NULL && slot->jstr != NULL
+			&& (*jniEnv)->IsSameObject(jniEnv, slot->jstr, jstr)) {
+		g_mutex_lock(stringTableMutex);
+		poolStats.n_reuses++;
+		g_mutex_unlock(stringTableMutex);
+		return slot->str;
+	}
+
+	const gchar *utf = (*jniEnv)->GetStringUTFChars(jniEnv, jstr, NULL);
+	if (utf == NULL) {
+		return slot->str;
+	}
+
+	const gchar *str = jaw_string_pool_intern(utf);
+	(*jniEnv)->ReleaseStringUTFChars(jniEnv, jstr, utf);
+
+	jaw_string_slot_clear(jniEnv, slot);
+	slot->jstr = (*jniEnv)->NewWeakGlobalRef(jniEnv, jstr);
+	slot->str = str;
+
+	return slot->str;
+}
+
+// Like jaw_string_slot_set, for text that did not come from a Java String
+const gchar*
+jaw_string_slot_set_text (JNIEnv *jniEnv, JawStringSlot *slot, const gchar *text)
+{
+	if (text == NULL) {
+		jaw_string_slot_clear(jniEnv, slot);
+		return NULL;
+	}
+
+	if (slot->str != NULL && strcmp(slot->str, text) == 0) {
+		g_mutex_lock(stringTableMutex);
+		poolStats.n_reuses++;
+		g_mutex_unlock(stringTableMutex);
+		return slot->str;
+	}
+
+	const gchar *str = jaw_string_pool_intern(text);
+
+	jaw_string_slot_clear(jniEnv, slot);
+	slot->str = str;
+
+	return slot->str;
+}
+
+void
+jaw_string_slot_clear (JNIEnv *jniEnv, JawStringSlot *slot)
+{
+	if (slot->jstr != NULL) {
+		(*jniEnv)->DeleteWeakGlobalRef(jniEnv, slot->jstr);
+		slot->jstr = NULL;
+	}
+
+	if (slot->str != NULL) {
+		jaw_string_pool_release(slot->str);
+		slot->str = NULL;
+	}
+}
+
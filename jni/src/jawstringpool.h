@@ -0,0 +1,61 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_STRING_POOL_H_
+#define _JAW_STRING_POOL_H_
+
+#include <glib.h>
+#include <jni.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A string slot remembers the Java String it was last filled from, so that
+ * asking again for an unchanged name does not convert it a second time.
+ * The UTF-8 text itself is interned in the pool and shared between slots.
+ */
+typedef struct _JawStringSlot {
+	jweak jstr;
+	const gchar *str;
+} JawStringSlot;
+
+typedef struct _JawStringPoolStats {
+	guint n_strings;
+	guint n_refs;
+	gsize bytes_used;
+	gsize bytes_shared;
+	guint64 n_lookups;
+	guint64 n_hits;
+	guint64 n_reuses;
+} JawStringPoolStats;
+
+void		jaw_string_pool_init(void);
+const gchar*	jaw_string_pool_intern(const gchar *str);
+void		jaw_string_pool_release(const gchar *str);
+void		jaw_string_pool_get_stats(JawStringPoolStats *stats);
+void		jaw_string_pool_dump_stats(void);
+
+const gchar*	jaw_string_slot_set(JNIEnv *jniEnv, JawStringSlot *slot, jstring jstr);
+const gchar*	jaw_string_slot_set_text(JNIEnv *jniEnv, JawStringSlot *slot, const gchar *text);
+void		jaw_string_slot_clear(JNIEnv *jniEnv, JawStringSlot *slot);
+
+G_END_DECLS
+
+#endif
+
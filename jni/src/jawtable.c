@@ -21,6 +21,7 @@
 #include <glib.h>
 #include "jawimpl.h"
 #include "jawutil.h"
+#include "jawprefetch.h"
 
 extern void	jaw_table_interface_init (AtkTableIface*);
 extern gpointer	jaw_table_data_init (jobject ac);
@@ -68,8 +69,8 @@ static gboolean			jaw_table_is_selected			(AtkTable	*table,
 
 typedef struct _TableData {
 	jobject atk_table;
-	gchar* description;
-	jstring jstrDescription;
+	JawStringSlot description;
+	JawPrefetch *prefetch;
 } TableData;
 
 void
@@ -117,29 +118,60 @@ jaw_table_data_finalize (gpointer p)
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 
 	if (data && data->atk_table) {
-		if (data->description != NULL) {
-			(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrDescription, data->description);
-			(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrDescription);
-			data->jstrDescription = NULL;
-			data->description = NULL;
-		}
+		jaw_string_slot_clear(jniEnv, &data->description);
+		jaw_prefetch_free(jniEnv, data->prefetch);
+		data->prefetch = NULL;
 
 		(*jniEnv)->DeleteGlobalRef(jniEnv, data->atk_table);
 		data->atk_table = NULL;
 	}
 }
 
+// Cells read along a row are fetched ahead, see jawprefetch.h
+static jobject
+ref_cell_context (JNIEnv *jniEnv, JawObject *jaw_obj, TableData *data, gint row, gint column)
+{
+	jobject atk_table = data->atk_table;
+	jclass classAtkTable = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkTable");
+	jmethodID jmid;
+
+	if (jaw_prefetch_get_depth() > 0) {
+		if (data->prefetch == NULL) {
+			data->prefetch = jaw_prefetch_new(JAW_PREFETCH_CELLS);
+		}
+
+		if (jaw_prefetch_lookup(jniEnv, data->prefetch, row, column, column + 1,
+					jaw_obj->children_generation)) {
+			return jaw_prefetch_get_object(jniEnv, data->prefetch, column);
+		}
+
+		if (jaw_prefetch_should_fetch(data->prefetch)) {
+			jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkTable, "ref_row_at", "(III)[Ljavax/accessibility/AccessibleContext;");
+			jobjectArray jcells = (*jniEnv)->CallObjectMethod(jniEnv, atk_table, jmid,
+					(jint)row, (jint)column, (jint)jaw_prefetch_get_depth());
+			if (jcells != NULL) {
+				jsize n = (*jniEnv)->GetArrayLength(jniEnv, jcells);
+				jaw_prefetch_store(jniEnv, data->prefetch, jcells, column, column + n,
+						jaw_obj->children_generation);
+				if (n > 0) {
+					return jaw_prefetch_get_object(jniEnv, data->prefetch, column);
+				}
+			}
+		}
+	}
+
+	jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkTable, "ref_at", "(II)Ljavax/accessibility/AccessibleContext;");
+	return (*jniEnv)->CallObjectMethod(jniEnv, atk_table, jmid, (jint)row, (jint)column);
+}
+
 static AtkObject*
 jaw_table_ref_at (AtkTable *table, gint	row, gint column)
 {
 	JawObject *jaw_obj = JAW_OBJECT(table);
 	TableData *data = jaw_object_get_interface_data(jaw_obj, INTERFACE_TABLE);
-	jobject atk_table = data->atk_table;
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
-	jclass classAtkTable = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkTable");
-	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkTable, "ref_at", "(II)Ljavax/accessibility/AccessibleContext;");
-	jobject jac = (*jniEnv)->CallObjectMethod(jniEnv, atk_table, jmid, (jint)row, (jint)column);
+	jobject jac = ref_cell_context(jniEnv, jaw_obj, data, row, column);
 
 	if (!jac) {
 		return NULL;
@@ -290,15 +322,7 @@ jaw_table_get_column_description (AtkTable *table, gint	column)
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkTable, "get_column_description", "(I)Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_table, jmid, (jint)column);
 
-	if (data->description != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrDescription, data->description);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrDescription);
-	}
-	
-	data->jstrDescription = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-	data->description = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, data->jstrDescription, NULL);
-
-	return data->description;
+	return jaw_string_slot_set(jniEnv, &data->description, jstr);
 }
 
 static const gchar*
@@ -313,15 +337,7 @@ jaw_table_get_row_description (AtkTable *table, gint row)
 	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkTable, "get_row_description", "(I)Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod(jniEnv, atk_table, jmid, (jint)row);
 
-	if (data->description != NULL) {
-		(*jniEnv)->ReleaseStringUTFChars(jniEnv, data->jstrDescription, data->description);
-		(*jniEnv)->DeleteGlobalRef(jniEnv, data->jstrDescription);
-	}
-	
-	data->jstrDescription = (*jniEnv)->NewGlobalRef(jniEnv, jstr);
-	data->description = (gchar*)(*jniEnv)->GetStringUTFChars(jniEnv, data->jstrDescription, NULL);
-
-	return data->description;
+	return jaw_string_slot_set(jniEnv, &data->description, jstr);
 }
 
 static AtkObject*
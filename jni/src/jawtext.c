@@ -21,6 +21,7 @@
 #include <glib.h>
 #include "jawimpl.h"
 #include "jawutil.h"
+#include "jawprefetch.h"
 
 extern void	jaw_text_interface_init	(AtkTextIface*);
 extern gpointer	jaw_text_data_init	(jobject);
@@ -85,6 +86,7 @@ typedef struct _TextData {
 	jobject atk_text;
 	gchar* text;
 	jstring jstrText;
+	JawPrefetch *prefetch;
 }TextData;
 
 void
@@ -136,6 +138,9 @@ jaw_text_data_finalize (gpointer p)
 			data->text = NULL;
 		}
 
+		jaw_prefetch_free(jniEnv, data->prefetch);
+		data->prefetch = NULL;
+
 		(*jniEnv)->DeleteGlobalRef(jniEnv, data->atk_text);
 		data->atk_text = NULL;
 	}
@@ -177,7 +182,37 @@ jaw_text_get_text (AtkText *text,
 
 	JNIEnv *jniEnv = jaw_util_get_jni_env();
 	jclass classAtkText = (*jniEnv)->FindClass(jniEnv, "org/GNOME/Accessibility/AtkText");
-	jmethodID jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkText, "get_text", "(II)Ljava/lang/String;");
+	jmethodID jmid;
+
+	// Chunks read one after the other are fetched ahead, see jawprefetch.h
+	if (jaw_prefetch_get_depth() > 0 && start_offset >= 0 && end_offset > start_offset) {
+		if (data->prefetch == NULL) {
+			data->prefetch = jaw_prefetch_new(JAW_PREFETCH_TEXT);
+		}
+
+		if (jaw_prefetch_lookup(jniEnv, data->prefetch, 0, start_offset, end_offset,
+					jaw_obj->content_generation)) {
+			return jaw_prefetch_get_text(jniEnv, data->prefetch, start_offset, end_offset);
+		}
+
+		if (jaw_prefetch_should_fetch(data->prefetch)) {
+			gint64 ahead = start_offset
+				+ (gint64)(end_offset - start_offset) * jaw_prefetch_get_depth();
+			jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkText, "get_text_ahead", "(II)Ljava/lang/String;");
+			jstring jahead = (*jniEnv)->CallObjectMethod( jniEnv, atk_text, jmid,
+					(jint)start_offset, (jint)MIN(ahead, G_MAXINT) );
+			if (jahead != NULL) {
+				gint len = (gint)(*jniEnv)->GetStringLength(jniEnv, jahead);
+				jaw_prefetch_store(jniEnv, data->prefetch, jahead, start_offset,
+						start_offset + len, jaw_obj->content_generation);
+				if (start_offset + len >= end_offset) {
+					return jaw_prefetch_get_text(jniEnv, data->prefetch, start_offset, end_offset);
+				}
+			}
+		}
+	}
+
+	jmid = (*jniEnv)->GetMethodID(jniEnv, classAtkText, "get_text", "(II)Ljava/lang/String;");
 	jstring jstr = (*jniEnv)->CallObjectMethod( jniEnv, atk_text, jmid, (jint)start_offset, (jint)end_offset );
 
 	return jaw_text_get_gtext_from_jstr(jniEnv, data, jstr);
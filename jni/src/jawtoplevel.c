@@ -19,8 +19,11 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 #include "jawtoplevel.h"
+#include "jawsnapshot.h"
+#include "jawutil.h"
 
 static void		jaw_toplevel_class_init		(JawToplevelClass	*klass);
 static void		jaw_toplevel_init		(JawToplevel		*toplevel);
@@ -62,7 +65,9 @@ jaw_toplevel_class_init (JawToplevelClass *klass)
 static void
 jaw_toplevel_init (JawToplevel *toplevel)
 {
-	toplevel->windows = NULL;
+	toplevel->windows = g_ptr_array_new();
+	toplevel->window_index = g_hash_table_new(NULL, NULL);
+	toplevel->name = NULL;
 }
 
 static void
@@ -76,7 +81,9 @@ static void
 jaw_toplevel_object_finalize (GObject *obj)
 {
 	JawToplevel *jaw_toplevel = JAW_TOPLEVEL(obj);
-	g_list_free(jaw_toplevel->windows);
+	g_ptr_array_free(jaw_toplevel->windows, TRUE);
+	g_hash_table_destroy(jaw_toplevel->window_index);
+	g_free(jaw_toplevel->name);
 
 	JawToplevelClass *klass = JAW_TOPLEVEL_GET_CLASS(obj);
 	G_OBJECT_CLASS(jaw_toplevel_parent_class)->finalize(obj);
@@ -85,18 +92,35 @@ jaw_toplevel_object_finalize (GObject *obj)
 static G_CONST_RETURN gchar*
 jaw_toplevel_get_name (AtkObject *obj)
 {
+	JawToplevel *jaw_toplevel = JAW_TOPLEVEL(obj);
 	gint i;
+
+	// Only looked up again after the windows or their names changed
+	if (jaw_toplevel->name != NULL) {
+		return jaw_toplevel->name;
+	}
+
 	for(i = 0; i < atk_object_get_n_accessible_children(obj); i++) {
 		AtkObject* child = atk_object_ref_accessible_child(obj, i);
 		const gchar* name = atk_object_get_name(child);
 		if (name && strlen(name) > 0) {
+			jaw_toplevel->name = g_strdup(name);
 			g_object_unref(G_OBJECT(child));
-			return name;
+			return jaw_toplevel->name;
 		}
 		g_object_unref(G_OBJECT(child));
 	}
 
-	return "Java Application";
+	jaw_toplevel->name = g_strdup("Java Application");
+
+	return jaw_toplevel->name;
+}
+
+static void
+invalidate_name (JawToplevel *toplevel)
+{
+	g_free(toplevel->name);
+	toplevel->name = NULL;
 }
 
 static G_CONST_RETURN gchar*
@@ -109,7 +133,7 @@ static gint
 jaw_toplevel_get_n_children (AtkObject *obj)
 {
 	JawToplevel* jaw_toplevel = JAW_TOPLEVEL(obj);
-	gint n = g_list_length(jaw_toplevel->windows);
+	gint n = (gint)jaw_toplevel->windows->len;
 
 	return n;
 }
@@ -118,7 +142,7 @@ static gint
 jaw_toplevel_get_index_in_parent (AtkObject *obj)
 {
 	JawToplevel *jaw_toplevel = JAW_TOPLEVEL(obj);
-	gint i = g_list_index(jaw_toplevel->windows, obj);
+	gint i = jaw_toplevel_get_child_index(jaw_toplevel, obj);
 
 	return i;
 }
@@ -134,9 +158,18 @@ jaw_toplevel_ref_child (AtkObject *obj,
 			gint i)
 {
 	JawToplevel *jaw_toplevel = JAW_TOPLEVEL(obj);
-	AtkObject* child = (AtkObject*)g_list_nth_data(
+	if (i < 0 || i >= (gint)jaw_toplevel->windows->len) {
+		return NULL;
+	}
+
+	AtkObject* child = (AtkObject*)g_ptr_array_index(
 			jaw_toplevel->windows, i);
 
+	// An AT starts exploring the window, fill its caches at once
+	if (jaw_snapshot_is_enabled()) {
+		jaw_snapshot_ensure(jaw_util_get_jni_env(), JAW_OBJECT(child));
+	}
+
 	g_object_ref(G_OBJECT(child));
 
 	return child;
@@ -155,28 +188,43 @@ jaw_toplevel_add_window (JawToplevel *toplevel,
 	if (toplevel == NULL)
 		return -1;
 
-	if (g_list_index(toplevel->windows, child) != -1) {
+	if (jaw_toplevel_get_child_index(toplevel, child) != -1) {
 		return -1;
 	}
 
-	toplevel->windows = g_list_append(toplevel->windows, child);
+	invalidate_name(toplevel);
+
+	g_ptr_array_add(toplevel->windows, child);
+	g_hash_table_insert(toplevel->window_index, child,
+			GINT_TO_POINTER(toplevel->windows->len));
 
-	return g_list_index(toplevel->windows, child);
+	return (gint)toplevel->windows->len - 1;
 }
 
 gint jaw_toplevel_remove_window(JawToplevel *toplevel,
 		AtkObject *child)
 {
 	gint index = -1;
+	guint i;
 
 	if (toplevel == NULL)
 		return index;
 
-	if ((index = g_list_index(toplevel->windows, child)) == -1) {
+	if ((index = jaw_toplevel_get_child_index(toplevel, child)) == -1) {
 		return index;
 	}
 
-	toplevel->windows = g_list_remove(toplevel->windows, child);
+	invalidate_name(toplevel);
+
+	// Keep the order, children-changed reports the indexes
+	g_ptr_array_remove_index(toplevel->windows, index);
+	g_hash_table_remove(toplevel->window_index, child);
+
+	for (i = index; i < toplevel->windows->len; i++) {
+		g_hash_table_insert(toplevel->window_index,
+				g_ptr_array_index(toplevel->windows, i),
+				GINT_TO_POINTER(i + 1));
+	}
 
 	return index;
 }
@@ -184,8 +232,28 @@ gint jaw_toplevel_remove_window(JawToplevel *toplevel,
 gint jaw_toplevel_get_child_index(JawToplevel *toplevel,
 		AtkObject *child)
 {
-	gint i = g_list_index(toplevel->windows, child);
+	gint i = GPOINTER_TO_INT(g_hash_table_lookup(toplevel->window_index, child));
 
-	return i;
+	return i - 1;
+}
+
+void jaw_toplevel_window_name_changed(JawToplevel *toplevel,
+		AtkObject *child)
+{
+	if (toplevel == NULL || jaw_toplevel_get_child_index(toplevel, child) == -1) {
+		return;
+	}
+
+	// Nobody read the old name, nobody has to hear about the new one
+	gchar *old_name = toplevel->name;
+	if (old_name == NULL) {
+		return;
+	}
+
+	toplevel->name = NULL;
+	if (g_strcmp0(old_name, atk_object_get_name(ATK_OBJECT(toplevel))) != 0) {
+		g_object_notify(G_OBJECT(toplevel), "accessible-name");
+	}
+	g_free(old_name);
 }
 
@@ -38,7 +38,11 @@ struct _JawToplevel
 {
 	AtkObject parent;
 
-	GList *windows;
+	GPtrArray *windows;
+	// Window to its index in windows plus one
+	GHashTable *window_index;
+	// Name of the first named window, NULL until asked for again
+	gchar *name;
 };
 
 GType jaw_toplevel_get_type (void);
@@ -51,6 +55,7 @@ struct _JawToplevelClass
 gint jaw_toplevel_add_window(JawToplevel*, AtkObject*);
 gint jaw_toplevel_remove_window(JawToplevel*, AtkObject*);
 gint jaw_toplevel_get_child_index(JawToplevel*, AtkObject*);
+void jaw_toplevel_window_name_changed(JawToplevel*, AtkObject*);
 
 G_END_DECLS
 
@@ -0,0 +1,232 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include "jawtrace.h"
+
+/*
+ * Log-linear buckets in the HDR histogram style: values below
+ * 2^JAW_TRACE_SUB_BITS have a bucket each, above that every power of
+ * two is split in 2^JAW_TRACE_SUB_BITS linear buckets, which keeps the
+ * relative error under 1/16 whatever the magnitude.
+ */
+#define JAW_TRACE_SUB_BITS	4
+#define JAW_TRACE_SUB_COUNT	(1 << JAW_TRACE_SUB_BITS)
+// Values are microseconds, anything above 2^32 us (71 minutes) is clamped
+#define JAW_TRACE_MAX_BITS	32
+#define JAW_TRACE_N_BUCKETS	((JAW_TRACE_MAX_BITS - JAW_TRACE_SUB_BITS + 1) * JAW_TRACE_SUB_COUNT)
+
+typedef struct _JawHistogram {
+	guint64 n_values;
+	guint64 max_value;
+	guint64 counts[JAW_TRACE_N_BUCKETS];
+} JawHistogram;
+
+static GMutex *traceMutex = NULL;
+static JawHistogram *histograms[JAW_TRACE_N_TYPES][JAW_TRACE_N_STAGES];
+
+static const gchar *stageNames[JAW_TRACE_N_STAGES] = {
+	"queue",
+	"emit"
+};
+
+static const gchar *typeNames[JAW_TRACE_N_TYPES - JAW_TRACE_N_SIGNALS] = {
+	"focus",
+	"state-change",
+	"window-open",
+	"window-close",
+	"window-minimize",
+	"window-maximize",
+	"window-restore",
+	"window-activate",
+	"window-deactivate"
+};
+
+static guint
+value_to_bucket (guint64 value)
+{
+	guint magnitude;
+
+	if (value < JAW_TRACE_SUB_COUNT) {
+		return (guint)value;
+	}
+
+	magnitude = g_bit_storage(value) - 1;
+	if (magnitude >= JAW_TRACE_MAX_BITS) {
+		return JAW_TRACE_N_BUCKETS - 1;
+	}
+
+	return ((magnitude - JAW_TRACE_SUB_BITS + 1) << JAW_TRACE_SUB_BITS)
+		+ (guint)((value >> (magnitude - JAW_TRACE_SUB_BITS)) & (JAW_TRACE_SUB_COUNT - 1));
+}
+
+static guint64
+bucket_to_value (guint bucket)
+{
+	guint magnitude;
+
+	if (bucket < JAW_TRACE_SUB_COUNT) {
+		return bucket;
+	}
+
+	magnitude = (bucket >> JAW_TRACE_SUB_BITS) + JAW_TRACE_SUB_BITS - 1;
+
+	return ((guint64)1 << magnitude)
+		+ ((guint64)(bucket & (JAW_TRACE_SUB_COUNT - 1)) << (magnitude - JAW_TRACE_SUB_BITS));
+}
+
+void
+jaw_trace_init (void)
+{
+	if (traceMutex == NULL) {
+		traceMutex = g_mutex_new();
+	}
+}
+
+void
+jaw_trace_record (guint type, JawTraceStage stage, gint64 usec)
+{
+	JawHistogram *histogram;
+	guint64 value;
+
+	if (type >= JAW_TRACE_N_TYPES || stage >= JAW_TRACE_N_STAGES) {
+		return;
+	}
+
+	// Clocks of both sides are the same, but be safe against skew
+	value = usec > 0 ? (guint64)usec : 0;
+
+	g_mutex_lock(traceMutex);
+
+	histogram = histograms[type][stage];
+	if (histogram == NULL) {
+		histogram = g_new0(JawHistogram, 1);
+		histograms[type][stage] = histogram;
+	}
+
+	histogram->counts[value_to_bucket(value)]++;
+	histogram->n_values++;
+	if (value > histogram->max_value) {
+		histogram->max_value = value;
+	}
+
+	g_mutex_unlock(traceMutex);
+}
+
+/*
+ * Returns the non empty buckets as pairs of (lowest value in us, count),
+ * n_buckets is the number of pairs. Free the result with g_free().
+ */
+guint64*
+jaw_trace_get_histogram (guint type, JawTraceStage stage, guint *n_buckets)
+{
+	JawHistogram *histogram;
+	guint64 *result = NULL;
+	guint bucket;
+	guint n = 0;
+
+	*n_buckets = 0;
+	if (type >= JAW_TRACE_N_TYPES || stage >= JAW_TRACE_N_STAGES) {
+		return NULL;
+	}
+
+	g_mutex_lock(traceMutex);
+
+	histogram = histograms[type][stage];
+	if (histogram != NULL) {
+		for (bucket = 0; bucket < JAW_TRACE_N_BUCKETS; bucket++) {
+			if (histogram->counts[bucket] > 0) {
+				n++;
+			}
+		}
+
+		result = g_new(guint64, n * 2);
+		n = 0;
+		for (bucket = 0; bucket < JAW_TRACE_N_BUCKETS; bucket++) {
+			if (histogram->counts[bucket] > 0) {
+				result[n * 2] = bucket_to_value(bucket);
+				result[n * 2 + 1] = histogram->counts[bucket];
+				n++;
+			}
+		}
+	}
+
+	g_mutex_unlock(traceMutex);
+
+	*n_buckets = n;
+
+	return result;
+}
+
+static guint64
+get_percentile (JawHistogram *histogram, guint percent)
+{
+	guint64 rank = (histogram->n_values * percent + 99) / 100;
+	guint64 seen = 0;
+	guint bucket;
+
+	for (bucket = 0; bucket < JAW_TRACE_N_BUCKETS; bucket++) {
+		seen += histogram->counts[bucket];
+		if (seen >= rank && seen > 0) {
+			return bucket_to_value(bucket);
+		}
+	}
+
+	return histogram->max_value;
+}
+
+void
+jaw_trace_dump_stats (void)
+{
+	guint type;
+	guint stage;
+
+	g_mutex_lock(traceMutex);
+
+	for (type = 0; type < JAW_TRACE_N_TYPES; type++) {
+		for (stage = 0; stage < JAW_TRACE_N_STAGES; stage++) {
+			JawHistogram *histogram = histograms[type][stage];
+			gchar *name;
+
+			if (histogram == NULL) {
+				continue;
+			}
+
+			if (type < JAW_TRACE_N_SIGNALS) {
+				name = g_strdup_printf("signal %u", type);
+			} else {
+				name = g_strdup(typeNames[type - JAW_TRACE_N_SIGNALS]);
+			}
+
+			g_printerr("Latency %s %s: %" G_GUINT64_FORMAT " events, p50 %"
+					G_GUINT64_FORMAT " us, p90 %" G_GUINT64_FORMAT " us, p99 %"
+					G_GUINT64_FORMAT " us, max %" G_GUINT64_FORMAT " us\n",
+					name, stageNames[stage], histogram->n_values,
+					get_percentile(histogram, 50),
+					get_percentile(histogram, 90),
+					get_percentile(histogram, 99),
+					histogram->max_value);
+
+			g_free(name);
+		}
+	}
+
+	g_mutex_unlock(traceMutex);
+}
+
@@ -0,0 +1,63 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _JAW_TRACE_H_
+#define _JAW_TRACE_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Latency histograms of the event path. Java stamps each event with
+ * System.nanoTime(), which is CLOCK_MONOTONIC like g_get_monotonic_time(),
+ * so both sides can be compared directly.
+ */
+
+// AtkSignal ids come first, the other events follow
+#define JAW_TRACE_N_SIGNALS	32
+
+typedef enum _JawTraceType {
+	JAW_TRACE_FOCUS = JAW_TRACE_N_SIGNALS,
+	JAW_TRACE_STATE_CHANGE,
+	JAW_TRACE_WINDOW_OPEN,
+	JAW_TRACE_WINDOW_CLOSE,
+	JAW_TRACE_WINDOW_MINIMIZE,
+	JAW_TRACE_WINDOW_MAXIMIZE,
+	JAW_TRACE_WINDOW_RESTORE,
+	JAW_TRACE_WINDOW_ACTIVATE,
+	JAW_TRACE_WINDOW_DEACTIVATE,
+	JAW_TRACE_N_TYPES
+} JawTraceType;
+
+typedef enum _JawTraceStage {
+	JAW_TRACE_STAGE_QUEUE = 0,	// Java emission until the handler runs
+	JAW_TRACE_STAGE_EMIT,		// handler start until the ATK signal returned
+	JAW_TRACE_N_STAGES
+} JawTraceStage;
+
+void		jaw_trace_init(void);
+void		jaw_trace_record(guint type, JawTraceStage stage, gint64 usec);
+guint64*	jaw_trace_get_histogram(guint type, JawTraceStage stage, guint *n_buckets);
+void		jaw_trace_dump_stats(void);
+
+G_END_DECLS
+
+#endif
+
@@ -19,6 +19,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 #include "jawutil.h"
 #include "jawtoplevel.h"
@@ -46,6 +47,8 @@ static void		jaw_misc_threads_enter			(AtkMisc		*misc);
 static void		jaw_misc_threads_leave			(AtkMisc		*misc);
 
 static void		_listener_info_destroy			(gpointer		data);
+static void		hooked_signal_ref			(guint			signal_id);
+static void		hooked_signal_unref			(guint			signal_id);
 static guint            add_listener	                        (GSignalEmissionHook    listener,
                                                                  const gchar            *object_type,
                                                                  const gchar            *signal,
@@ -53,7 +56,9 @@ static guint            add_listener	                        (GSignalEmissionHoo
 
 static GHashTable *listener_list = NULL;
 static gint listener_idx = 1;
-static GHashTable *key_listener_list = NULL;
+// Number of emission hooks on each signal id
+static GHashTable *hooked_signals = NULL;
+static JawListenerChangedFunc listener_changed_func = NULL;
 
 typedef struct _JawUtilListenerInfo JawUtilListenerInfo;
 
@@ -163,6 +168,7 @@ jaw_util_remove_global_event_listener (guint remove_listener)
 						listener_info->signal_id,
 						listener_info->hook_id);
 
+				hooked_signal_unref(listener_info->signal_id);
 				g_hash_table_remove(listener_list, &tmp_idx);
 			}
 		}
@@ -170,63 +176,120 @@ jaw_util_remove_global_event_listener (guint remove_listener)
 }
 
 typedef struct _JawKeyListenerInfo{
+	guint key;
 	AtkKeySnoopFunc listener;
 	gpointer data;
 }JawKeyListenerInfo;
 
-static gboolean
-notify_hf (gpointer key, gpointer value, gpointer data)
-{
-	JawKeyListenerInfo *info = (JawKeyListenerInfo*)value;
-	AtkKeyEventStruct *key_event = (AtkKeyEventStruct*)data;
+// Never changed once published, add and remove publish a new one
+typedef struct _JawKeyListenerSnapshot{
+	guint n_listeners;
+	JawKeyListenerInfo listeners[1];
+}JawKeyListenerSnapshot;
 
-	AtkKeySnoopFunc func = info->listener;
-	gpointer func_data = info->data;
+static JawKeyListenerSnapshot *key_listener_snapshot = NULL;
+static GMutex *key_listener_mutex = NULL;
+// Snapshots replaced while a dispatch may still be reading them
+static GSList *retired_key_snapshots = NULL;
+static gint key_dispatch_readers = 0;
 
-	return (*func)(key_event, func_data) ? TRUE : FALSE;
-}
-
-static void
-insert_hf (gpointer key, gpointer value, gpointer data)
+void
+jaw_util_init_mutex (void)
 {
-	GHashTable *new_table = (GHashTable *) data;
-	g_hash_table_insert (new_table, key, value);
+	if (key_listener_mutex == NULL) {
+		key_listener_mutex = g_mutex_new();
+	}
 }
 
 gboolean
 jaw_util_dispatch_key_event (AtkKeyEventStruct *event)
 {
+	JawKeyListenerSnapshot *snapshot;
 	gint consumed = 0;
-	if (key_listener_list) {
-		GHashTable *new_hash = g_hash_table_new(NULL, NULL);
-		g_hash_table_foreach(key_listener_list, insert_hf, new_hash);
-		consumed = g_hash_table_foreach_steal(new_hash, notify_hf, event);
-		g_hash_table_destroy(new_hash);
+	guint i;
+
+	// Announce the reader before looking at the snapshot, see publish_key_listeners
+	g_atomic_int_inc(&key_dispatch_readers);
+	snapshot = (JawKeyListenerSnapshot*)g_atomic_pointer_get(&key_listener_snapshot);
+
+	if (snapshot) {
+		for (i = 0; i < snapshot->n_listeners; i++) {
+			JawKeyListenerInfo *info = &snapshot->listeners[i];
+			if ((*info->listener)(event, info->data)) {
+				consumed++;
+			}
+		}
 	}
 
+	g_atomic_int_add(&key_dispatch_readers, -1);
+
 	return (consumed > 0) ? TRUE : FALSE;
 }
 
+static JawKeyListenerSnapshot*
+new_key_listener_snapshot (guint n_listeners)
+{
+	JawKeyListenerSnapshot *snapshot = (JawKeyListenerSnapshot*)g_malloc0(
+			G_STRUCT_OFFSET(JawKeyListenerSnapshot, listeners)
+			+ MAX(n_listeners, 1) * sizeof(JawKeyListenerInfo));
+	snapshot->n_listeners = n_listeners;
+
+	return snapshot;
+}
+
+// Called with key_listener_mutex held
+static void
+publish_key_listeners (JawKeyListenerSnapshot *snapshot)
+{
+	JawKeyListenerSnapshot *old = key_listener_snapshot;
+
+	g_atomic_pointer_set(&key_listener_snapshot, snapshot);
+
+	if (old != NULL) {
+		retired_key_snapshots = g_slist_prepend(retired_key_snapshots, old);
+	}
+
+	// A dispatch that starts from now on only sees the new snapshot,
+	// without readers nobody can hold an old one
+	if (g_atomic_int_get(&key_dispatch_readers) == 0) {
+		g_slist_foreach(retired_key_snapshots, (GFunc)g_free, NULL);
+		g_slist_free(retired_key_snapshots);
+		retired_key_snapshots = NULL;
+	}
+}
+
 static guint
 jaw_util_add_key_event_listener (AtkKeySnoopFunc listener,
 				gpointer data)
 {
 	static guint key = 0;
+	JawKeyListenerSnapshot *snapshot;
+	guint n = 0;
 
 	if (!listener) {
 		return 0;
 	}
 
-	if (!key_listener_list) {
-		key_listener_list = g_hash_table_new(NULL, NULL);
+	g_mutex_lock(key_listener_mutex);
+
+	if (key_listener_snapshot) {
+		n = key_listener_snapshot->n_listeners;
 	}
 
-	JawKeyListenerInfo *info = g_new0(JawKeyListenerInfo, 1);
-	info->listener = listener;
-	info->data = data;
+	snapshot = new_key_listener_snapshot(n + 1);
+	if (n > 0) {
+		memcpy(snapshot->listeners, key_listener_snapshot->listeners,
+				n * sizeof(JawKeyListenerInfo));
+	}
 
 	key++;
-	g_hash_table_insert(key_listener_list, GUINT_TO_POINTER(key), info);
+	snapshot->listeners[n].key = key;
+	snapshot->listeners[n].listener = listener;
+	snapshot->listeners[n].data = data;
+
+	publish_key_listeners(snapshot);
+
+	g_mutex_unlock(key_listener_mutex);
 
 	return key;
 }
@@ -234,13 +297,32 @@ jaw_util_add_key_event_listener (AtkKeySnoopFunc listener,
 static void
 jaw_util_remove_key_event_listener (guint remove_listener)
 {
-	gpointer *value = g_hash_table_lookup(
-			key_listener_list, GUINT_TO_POINTER(remove_listener));
-	if (value) {
-		g_free(value);
+	JawKeyListenerSnapshot *snapshot;
+	guint i, n = 0;
+
+	g_mutex_lock(key_listener_mutex);
+
+	if (key_listener_snapshot == NULL) {
+		g_mutex_unlock(key_listener_mutex);
+		return;
 	}
 
-	g_hash_table_remove(key_listener_list, GUINT_TO_POINTER(remove_listener));
+	snapshot = new_key_listener_snapshot(key_listener_snapshot->n_listeners);
+	for (i = 0; i < key_listener_snapshot->n_listeners; i++) {
+		if (key_listener_snapshot->listeners[i].key != remove_listener) {
+			snapshot->listeners[n++] = key_listener_snapshot->listeners[i];
+		}
+	}
+
+	if (n == key_listener_snapshot->n_listeners) {
+		// Not registered, keep the current snapshot
+		g_free(snapshot);
+	} else {
+		snapshot->n_listeners = n;
+		publish_key_listeners(snapshot);
+	}
+
+	g_mutex_unlock(key_listener_mutex);
 }
 
 static AtkObject*
@@ -274,6 +356,61 @@ _listener_info_destroy (gpointer data)
 	g_free (data);
 }
 
+static void
+hooked_signal_ref (guint signal_id)
+{
+	gint count;
+
+	if (hooked_signals == NULL) {
+		hooked_signals = g_hash_table_new(NULL, NULL);
+	}
+
+	count = GPOINTER_TO_INT(g_hash_table_lookup(hooked_signals, GUINT_TO_POINTER(signal_id)));
+	g_hash_table_insert(hooked_signals, GUINT_TO_POINTER(signal_id), GINT_TO_POINTER(count + 1));
+
+	if (count == 0 && listener_changed_func != NULL) {
+		listener_changed_func();
+	}
+}
+
+static void
+hooked_signal_unref (guint signal_id)
+{
+	gint count;
+
+	if (hooked_signals == NULL) {
+		return;
+	}
+
+	count = GPOINTER_TO_INT(g_hash_table_lookup(hooked_signals, GUINT_TO_POINTER(signal_id)));
+	if (count > 1) {
+		g_hash_table_insert(hooked_signals, GUINT_TO_POINTER(signal_id), GINT_TO_POINTER(count - 1));
+		return;
+	}
+
+	g_hash_table_remove(hooked_signals, GUINT_TO_POINTER(signal_id));
+
+	if (count == 1 && listener_changed_func != NULL) {
+		listener_changed_func();
+	}
+}
+
+gboolean
+jaw_util_is_signal_hooked (guint signal_id)
+{
+	if (hooked_signals == NULL || signal_id == 0) {
+		return FALSE;
+	}
+
+	return g_hash_table_lookup(hooked_signals, GUINT_TO_POINTER(signal_id)) != NULL;
+}
+
+void
+jaw_util_set_listener_changed_func (JawListenerChangedFunc func)
+{
+	listener_changed_func = func;
+}
+
 static guint
 add_listener (	GSignalEmissionHook listener,
 		const gchar         *object_type,
@@ -305,6 +442,8 @@ add_listener (	GSignalEmissionHook listener,
 
 			g_hash_table_insert(listener_list, &(listener_info->key), listener_info);
 			listener_idx++;
+
+			hooked_signal_ref(signal_id);
 		} else {
 			g_warning("Invalid signal type %s\n", signal);
 		}
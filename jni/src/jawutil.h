@@ -70,8 +70,15 @@ AtkRole		jaw_util_get_atk_role_from_jobj(jobject jobj);
 AtkStateType	jaw_util_get_atk_state_type_from_java_state(JNIEnv *jniEnv, jobject jobj);
 void		jaw_util_get_rect_info(JNIEnv *jniEnv, jobject jrect,
 			gint *x, gint *y, gint *width, gint *height);
+void		jaw_util_init_mutex(void);
 gboolean	jaw_util_dispatch_key_event (AtkKeyEventStruct *event);
 
+// Called when a signal gains its first or loses its last emission hook
+typedef void (*JawListenerChangedFunc) (void);
+
+gboolean	jaw_util_is_signal_hooked(guint signal_id);
+void		jaw_util_set_listener_changed_func(JawListenerChangedFunc func);
+
 #define JAW_TYPE_MISC                           (jaw_misc_get_type ())
 #define JAW_MISC_CLASS(klass)                   (G_TYPE_CHECK_CLASS_CAST ((klass), JAW_TYPE_MISC, JawMiscClass))
 #define JAW_IS_MISC(obj)                        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), JAW_TYPE_MISC))
@@ -0,0 +1,308 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <glib.h>
+#include "jawevent.h"
+
+/*
+ * Exercises the event lanes without Java or the ATK bridge. The queue
+ * runs with its smallest capacity, so a flood overflows it quickly.
+ * Handlers record the order they ran in, the tests drain the private
+ * context by hand.
+ */
+
+#define TEST_CAPACITY		JAW_EVENT_QUEUE_MIN_SIZE
+#define TEST_KIND		1
+
+typedef struct _TestEvent {
+	gint id;
+	gint64 posted;
+} TestEvent;
+
+static GArray *dispatched = NULL;	// ids in dispatch order
+static gint64 focusLatency = -1;
+static gint64 bulkLatency = -1;
+static gboolean keepFocusBusy = FALSE;
+static guint nCompacted = 0;
+
+static TestEvent*
+test_event_new (gint id)
+{
+	TestEvent *event = g_new(TestEvent, 1);
+	event->id = id;
+	event->posted = g_get_monotonic_time();
+	return event;
+}
+
+static gboolean
+record_handler (gpointer p)
+{
+	TestEvent *event = (TestEvent*)p;
+	g_array_append_val(dispatched, event->id);
+	g_free(event);
+	return FALSE;
+}
+
+static gboolean
+focus_handler (gpointer p)
+{
+	TestEvent *event = (TestEvent*)p;
+	focusLatency = g_get_monotonic_time() - event->posted;
+	return record_handler(p);
+}
+
+static gboolean
+busy_focus_handler (gpointer p)
+{
+	if (keepFocusBusy) {
+		// Keeps the focus lane from ever running empty
+		g_usleep(1000);
+		jaw_event_post(JAW_EVENT_LANE_FOCUS, busy_focus_handler,
+				test_event_new(0), g_free);
+	}
+
+	return record_handler(p);
+}
+
+static gboolean
+bulk_latency_handler (gpointer p)
+{
+	TestEvent *event = (TestEvent*)p;
+	bulkLatency = g_get_monotonic_time() - event->posted;
+	keepFocusBusy = FALSE;
+	return record_handler(p);
+}
+
+static void
+compact_func (gpointer p)
+{
+	nCompacted++;
+}
+
+static void
+drain (void)
+{
+	GMainContext *context = jaw_event_queue_get_context();
+	JawEventQueueStats stats;
+
+	do {
+		while (g_main_context_iteration(context, FALSE)) {
+		}
+		jaw_event_queue_get_stats(&stats);
+	} while (stats.n_pending > 0);
+}
+
+static void
+reset (void)
+{
+	drain();
+	g_array_set_size(dispatched, 0);
+	focusLatency = -1;
+	bulkLatency = -1;
+	nCompacted = 0;
+}
+
+static guint
+index_of (gint id)
+{
+	guint i;
+
+	for (i = 0; i < dispatched->len; i++) {
+		if (g_array_index(dispatched, gint, i) == id) {
+			return i;
+		}
+	}
+
+	g_assert_not_reached();
+	return 0;
+}
+
+// A focus change posted behind a flood goes out within one batch
+static void
+test_focus_beats_flood (void)
+{
+	GMainContext *context = jaw_event_queue_get_context();
+	JawEventQueueStats stats;
+	guint before;
+	gint i;
+
+	reset();
+
+	for (i = 1; i <= TEST_CAPACITY * 16; i++) {
+		jaw_event_post(JAW_EVENT_LANE_BULK, record_handler,
+				test_event_new(i), g_free);
+	}
+
+	// The queue stayed within its hard limit
+	jaw_event_queue_get_stats(&stats);
+	g_assert_cmpuint(stats.n_pending, <=, stats.hard_limit);
+	g_assert_cmpuint(stats.peak_pending, <=, stats.hard_limit);
+	g_assert_cmpuint(stats.n_dropped + stats.n_refused, >, 0);
+
+	g_main_context_iteration(context, FALSE);
+	before = dispatched->len;
+
+	jaw_event_post(JAW_EVENT_LANE_FOCUS, focus_handler,
+			test_event_new(-1), g_free);
+	while (focusLatency < 0) {
+		g_main_context_iteration(context, TRUE);
+	}
+
+	g_assert_cmpuint(index_of(-1) - before, <=, JAW_EVENT_BATCH_SIZE);
+	g_assert_cmpint(focusLatency, <, JAW_EVENT_STARVATION_USEC);
+}
+
+// A busy focus lane still lets a bulk event through after the bound
+static void
+test_bulk_not_starved (void)
+{
+	GMainContext *context = jaw_event_queue_get_context();
+	gint64 deadline;
+
+	reset();
+
+	keepFocusBusy = TRUE;
+	jaw_event_post(JAW_EVENT_LANE_FOCUS, busy_focus_handler,
+			test_event_new(0), g_free);
+	jaw_event_post(JAW_EVENT_LANE_BULK, bulk_latency_handler,
+			test_event_new(1), g_free);
+
+	deadline = g_get_monotonic_time() + 10 * JAW_EVENT_STARVATION_USEC;
+	while (bulkLatency < 0 && g_get_monotonic_time() < deadline) {
+		g_main_context_iteration(context, TRUE);
+	}
+	keepFocusBusy = FALSE;
+
+	g_assert_cmpint(bulkLatency, >=, JAW_EVENT_STARVATION_USEC);
+	g_assert_cmpint(bulkLatency, <, 3 * JAW_EVENT_STARVATION_USEC);
+}
+
+// Earlier events of an object move up with its focus event
+static void
+test_focus_promotes_earlier_events (void)
+{
+	reset();
+
+	jaw_event_post_compactable(JAW_EVENT_LANE_BULK, record_handler,
+			test_event_new(1), g_free, 100, 0, NULL);
+	jaw_event_post_compactable(JAW_EVENT_LANE_BULK, record_handler,
+			test_event_new(2), g_free, 200, 0, NULL);
+	jaw_event_post_compactable(JAW_EVENT_LANE_STATE, record_handler,
+			test_event_new(3), g_free, 200, 0, NULL);
+	jaw_event_post_compactable(JAW_EVENT_LANE_FOCUS, record_handler,
+			test_event_new(4), g_free, 200, 0, NULL);
+
+	drain();
+
+	g_assert_cmpuint(dispatched->len, ==, 4);
+	// The object's own events keep their order, ahead of the others
+	g_assert_cmpint(g_array_index(dispatched, gint, 0), ==, 2);
+	g_assert_cmpint(g_array_index(dispatched, gint, 1), ==, 3);
+	g_assert_cmpint(g_array_index(dispatched, gint, 2), ==, 4);
+	g_assert_cmpint(g_array_index(dispatched, gint, 3), ==, 1);
+}
+
+// Under pressure a burst for one object collapses into its first event
+static void
+test_compact_lane (void)
+{
+	JawEventQueueStats before, after;
+	gint i;
+
+	reset();
+	jaw_event_queue_get_stats(&before);
+
+	// The last one finds the queue full, well below its hard limit
+	for (i = 1; i <= TEST_CAPACITY + 1; i++) {
+		jaw_event_post_compactable(JAW_EVENT_LANE_BULK, record_handler,
+				test_event_new(i), g_free, 100, TEST_KIND, compact_func);
+	}
+
+	jaw_event_queue_get_stats(&after);
+	g_assert_cmpuint(after.n_compacted - before.n_compacted, ==, TEST_CAPACITY - 1);
+	g_assert_cmpuint(after.n_pending, ==, 2);
+	// Compactable events are collapsed, never dropped
+	g_assert_cmpuint(after.n_dropped, ==, before.n_dropped);
+	g_assert_cmpuint(nCompacted, ==, 1);
+
+	drain();
+
+	g_assert_cmpuint(dispatched->len, ==, 2);
+	g_assert_cmpint(g_array_index(dispatched, gint, 0), ==, 1);
+	g_assert_cmpint(g_array_index(dispatched, gint, 1), ==, TEST_CAPACITY + 1);
+}
+
+// Events that are never dropped still do not grow the queue past its limit
+static void
+test_hard_limit (void)
+{
+	JawEventQueueStats before, after;
+	gint i;
+
+	reset();
+	jaw_event_queue_get_stats(&before);
+
+	for (i = 1; i <= TEST_CAPACITY * 4; i++) {
+		jaw_event_post(JAW_EVENT_LANE_FOCUS, record_handler,
+				test_event_new(i), g_free);
+	}
+
+	jaw_event_queue_get_stats(&after);
+	g_assert_cmpuint(after.n_pending, ==, after.hard_limit);
+	g_assert_cmpuint(after.n_dropped - before.n_dropped,
+			==, TEST_CAPACITY * 4 - after.hard_limit);
+
+	// Nothing to merge with and not a focus event, it is refused
+	jaw_event_post_compactable(JAW_EVENT_LANE_BULK, record_handler,
+			test_event_new(-1), g_free, 300, TEST_KIND, compact_func);
+
+	jaw_event_queue_get_stats(&after);
+	g_assert_cmpuint(after.n_pending, ==, after.hard_limit);
+	g_assert_cmpuint(after.n_refused, ==, before.n_refused + 1);
+
+	drain();
+
+	// The newest focus events survived, in order
+	g_assert_cmpuint(dispatched->len, ==, after.hard_limit);
+	g_assert_cmpint(g_array_index(dispatched, gint, dispatched->len - 1), ==, TEST_CAPACITY * 4);
+}
+
+int
+main (int argc, char **argv)
+{
+	gchar *size = g_strdup_printf("%d", TEST_CAPACITY);
+
+	g_thread_init(NULL);
+	g_test_init(&argc, &argv, NULL);
+
+	g_setenv("JAW_EVENT_QUEUE_SIZE", size, TRUE);
+	g_free(size);
+
+	dispatched = g_array_new(FALSE, FALSE, sizeof(gint));
+	jaw_event_queue_init();
+	jaw_event_queue_set_ready();
+
+	g_test_add_func("/event/focus-beats-flood", test_focus_beats_flood);
+	g_test_add_func("/event/bulk-not-starved", test_bulk_not_starved);
+	g_test_add_func("/event/focus-promotes-earlier-events", test_focus_promotes_earlier_events);
+	g_test_add_func("/event/compact-lane", test_compact_lane);
+	g_test_add_func("/event/hard-limit", test_hard_limit);
+
+	return g_test_run();
+}
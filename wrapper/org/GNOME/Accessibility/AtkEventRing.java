@@ -0,0 +1,128 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+/*
+ * Writes events into a ring in native memory instead of calling into
+ * the native library for each of them, see jawring.c. Only created
+ * when JAW_EVENT_RING is set.
+ *
+ * The objects of a record are kept in slots until the record is
+ * consumed, the native side mostly finds the wrapper by its key.
+ */
+public class AtkEventRing {
+	// Record kinds, JawRingKind
+	static final int SIGNAL = 0;
+	static final int SIGNAL_OBJ = 1;
+	static final int STATE_CHANGE = 2;
+
+	// Layout, see jawring.h
+	static final int HEAD_OFFSET = 0;
+	static final int CAPACITY_OFFSET = 4;
+	static final int TAIL_OFFSET = 64;
+	static final int WAKEUP_OFFSET = 128;
+	static final int HEADER_SIZE = 192;
+	static final int RECORD_SIZE = 32;
+
+	final ByteBuffer buffer;
+	final int capacity;
+	final Object[] slots;
+	int head = 0;
+	long wakeups = 0;
+	long flushes = 0;
+
+	volatile int fence;
+
+	static AtkEventRing create() {
+		ByteBuffer buffer = createBuffer();
+		if (buffer == null) {
+			return null;
+		}
+
+		return new AtkEventRing(buffer);
+	}
+
+	AtkEventRing(ByteBuffer buffer) {
+		this.buffer = buffer.order(ByteOrder.nativeOrder());
+		capacity = this.buffer.getInt(CAPACITY_OFFSET);
+		slots = new Object[capacity * 2];
+		setSlots(slots);
+	}
+
+	// A volatile store followed by a volatile load, buffer accesses
+	// before it are not reordered with the ones after it
+	private int fullFence() {
+		fence = head;
+		return fence;
+	}
+
+	synchronized void post(int kind, int id, Object ac, int key,
+			int arg1, int arg2, Object extra, int extraKey, long when) {
+		if (head - buffer.getInt(TAIL_OFFSET) >= capacity) {
+			// The consumer is behind or not running yet, catch up on
+			// this thread so the events keep their order
+			flushes++;
+			flush();
+		}
+
+		int index = head & (capacity - 1);
+		int offset = HEADER_SIZE + index * RECORD_SIZE;
+
+		slots[index * 2] = ac;
+		slots[index * 2 + 1] = extra;
+
+		buffer.putInt(offset, kind);
+		buffer.putInt(offset + 4, id);
+		buffer.putInt(offset + 8, key);
+		buffer.putInt(offset + 12, arg1);
+		buffer.putInt(offset + 16, arg2);
+		buffer.putInt(offset + 20, extraKey);
+		buffer.putLong(offset + 24, when);
+
+		// The record has to be complete before head covers it
+		fullFence();
+		head++;
+		buffer.putInt(HEAD_OFFSET, head);
+
+		// and head visible before we look whether the consumer sleeps
+		fullFence();
+		if (buffer.getInt(WAKEUP_OFFSET) != 0) {
+			wakeups++;
+			wakeup();
+		}
+	}
+
+	synchronized long getWakeupCount() {
+		return wakeups;
+	}
+
+	synchronized long getFlushCount() {
+		return flushes;
+	}
+
+	native static ByteBuffer createBuffer();
+	native static void setSlots(Object[] slots);
+	native static void wakeup();
+	native static void flush();
+}
+
@@ -0,0 +1,39 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+/*
+ * Event types and stages understood by AtkWrapper.getLatencyHistogram.
+ * AtkSignal ids are event types as well.
+ */
+public interface AtkLatency {
+	public int FOCUS = 32;
+	public int STATE_CHANGE = 33;
+	public int WINDOW_OPEN = 34;
+	public int WINDOW_CLOSE = 35;
+	public int WINDOW_MINIMIZE = 36;
+	public int WINDOW_MAXIMIZE = 37;
+	public int WINDOW_RESTORE = 38;
+	public int WINDOW_ACTIVATE = 39;
+	public int WINDOW_DEACTIVATE = 40;
+
+	public int STAGE_QUEUE = 0;
+	public int STAGE_EMIT = 1;
+}
@@ -0,0 +1,234 @@
+/*
+ * Java ATK Wrapper for GNOME
+ * Copyright (C) 2009 Sun Microsystems Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+package org.GNOME.Accessibility;
+
+import java.awt.Dimension;
+import java.awt.EventQueue;
+import java.awt.Point;
+import java.io.*;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.WeakHashMap;
+import javax.accessibility.*;
+
+/*
+ * Writes the accessible tree below a context into one buffer, so the
+ * native side can fill its caches with a single call instead of
+ * several per node, see jawsnapshot.c. The tree is walked on the
+ * event dispatch thread.
+ *
+ * Roles and states are written as indexes into the roles and states
+ * arrays, native code maps each distinct entry only once. A role entry
+ * is a context standing in for all nodes with the same role and parent
+ * role, which is all the native role mapping looks at. The contexts
+ * themselves go along with the nodes, identity hashes are not unique.
+ *
+ * Native code keeps serving names, states and child counts from a
+ * node, so contexts that were in a snapshot always report their state
+ * and name changes, see isSnapshotted.
+ */
+public class AtkSnapshot {
+	static final int MAGIC = 0x4a415753;
+	static final int VERSION = 1;
+	static final int NO_BOUNDS = Integer.MIN_VALUE;
+	static final int MAX_STATES = 64;
+
+	// Every context written into a snapshot so far
+	static Map snapshotted = Collections.synchronizedMap(new WeakHashMap());
+
+	// Read by native code
+	byte[] data = null;
+	Object[] roles = null;
+	Object[] states = null;
+	Object[] contexts = null;
+
+	HashMap roleIndex = new HashMap();
+	ArrayList roleList = new ArrayList();
+	HashMap stateIndex = new HashMap();
+	ArrayList stateList = new ArrayList();
+	ArrayList contextList = new ArrayList();
+
+	/*
+	 * Walks the tree below root on the event dispatch thread and hands
+	 * the result to snapshotReady. Returns right away, the event
+	 * dispatch thread may be waiting for the native side.
+	 */
+	public static void request(final AccessibleContext root,
+			final int key, final int maxNodes) {
+		Runnable walk = new Runnable() {
+			public void run() {
+				AtkSnapshot snapshot = new AtkSnapshot();
+				snapshot.walk(root, maxNodes);
+				if (snapshot.data != null) {
+					snapshotReady(key, snapshot);
+				}
+			}
+		};
+
+		if (EventQueue.isDispatchThread()) {
+			walk.run();
+		} else {
+			EventQueue.invokeLater(walk);
+		}
+	}
+
+	// key is the identity hash of the root, see jawsnapshot.c
+	public native static void snapshotReady(int key, AtkSnapshot snapshot);
+
+	public static boolean isSnapshotted(AccessibleContext ac) {
+		return !snapshotted.isEmpty() && snapshotted.containsKey(ac);
+	}
+
+	private int getRoleIndex(AccessibleContext ac, AccessibleContext parent) {
+		AccessibleRole role = ac.getAccessibleRole();
+		AccessibleRole parentRole = (parent != null) ? parent.getAccessibleRole() : null;
+		String key = String.valueOf(role) + "|"
+			+ (parent != null ? String.valueOf(parentRole) : "");
+
+		Integer index = (Integer)roleIndex.get(key);
+		if (index == null) {
+			index = new Integer(roleList.size());
+			roleIndex.put(key, index);
+			roleList.add(ac);
+		}
+
+		return index.intValue();
+	}
+
+	private long getStateMask(AccessibleContext ac) {
+		AccessibleStateSet stateSet = ac.getAccessibleStateSet();
+		if (stateSet == null) {
+			return 0;
+		}
+
+		long mask = 0;
+		AccessibleState[] stateArray = stateSet.toArray();
+		for (int i = 0; i < stateArray.length; i++) {
+			Integer index = (Integer)stateIndex.get(stateArray[i]);
+			if (index == null) {
+				if (stateList.size() >= MAX_STATES) {
+					continue;
+				}
+				index = new Integer(stateList.size());
+				stateIndex.put(stateArray[i], index);
+				stateList.add(stateArray[i]);
+			}
+			mask |= 1L << index.intValue();
+		}
+
+		return mask;
+	}
+
+	private void writeNode(DataOutputStream out, AccessibleContext ac,
+			AccessibleContext parent, int parentNode, int indexInParent)
+			throws IOException {
+		out.writeInt(System.identityHashCode(ac));
+		contextList.add(ac);
+		snapshotted.put(ac, Boolean.TRUE);
+		out.writeInt(parentNode);
+		out.writeInt(indexInParent);
+		out.writeShort(getRoleIndex(ac, parent));
+		out.writeLong(getStateMask(ac));
+		out.writeInt(ac.getAccessibleChildrenCount());
+
+		Point location = null;
+		Dimension size = null;
+		AccessibleComponent component = ac.getAccessibleComponent();
+		if (component != null && component.isShowing()) {
+			location = component.getLocationOnScreen();
+			size = component.getSize();
+		}
+		if (location != null && size != null) {
+			out.writeInt(location.x);
+			out.writeInt(location.y);
+			out.writeInt(size.width);
+			out.writeInt(size.height);
+		} else {
+			out.writeInt(NO_BOUNDS);
+			out.writeInt(0);
+			out.writeInt(0);
+			out.writeInt(0);
+		}
+
+		String name = ac.getAccessibleName();
+		if (name == null) {
+			out.writeInt(-1);
+		} else {
+			byte[] bytes = name.getBytes("UTF-8");
+			out.writeInt(bytes.length);
+			out.write(bytes);
+		}
+	}
+
+	// Depth first, each node is followed by its subtree
+	private int walkNode(DataOutputStream out, AccessibleContext ac,
+			AccessibleContext parent, int parentNode, int indexInParent,
+			int node, int maxNodes) throws IOException {
+		writeNode(out, ac, parent, parentNode, indexInParent);
+		int self = node++;
+
+		int count = ac.getAccessibleChildrenCount();
+		for (int i = 0; i < count && node < maxNodes; i++) {
+			Accessible child = ac.getAccessibleChild(i);
+			if (child == null) {
+				continue;
+			}
+
+			AccessibleContext childContext = child.getAccessibleContext();
+			if (childContext != null) {
+				node = walkNode(out, childContext, ac, self, i, node, maxNodes);
+			}
+		}
+
+		return node;
+	}
+
+	void walk(AccessibleContext root, int maxNodes) {
+		ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+		DataOutputStream out = new DataOutputStream(bytes);
+
+		try {
+			ByteArrayOutputStream nodeBytes = new ByteArrayOutputStream();
+			DataOutputStream nodeOut = new DataOutputStream(nodeBytes);
+
+			Accessible parent = root.getAccessibleParent();
+			AccessibleContext parentContext = (parent != null) ? parent.getAccessibleContext() : null;
+			int n = walkNode(nodeOut, root, parentContext, -1,
+					root.getAccessibleIndexInParent(), 0, maxNodes);
+			nodeOut.flush();
+
+			out.writeInt(MAGIC);
+			out.writeInt(VERSION);
+			out.writeInt(n);
+			nodeBytes.writeTo(out);
+			out.flush();
+		} catch (IOException e) {
+			return;
+		}
+
+		roles = roleList.toArray();
+		states = stateList.toArray();
+		contexts = contextList.toArray();
+		data = bytes.toByteArray();
+	}
+}
+
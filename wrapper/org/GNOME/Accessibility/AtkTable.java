@@ -40,6 +40,21 @@ public class AtkTable {
 		return null;
 	}
 
+	// Up to count cells of row from column on, for the native prefetch
+	public AccessibleContext[] ref_row_at (int row, int column, int count) {
+		int n = Math.min(count, acc_table.getAccessibleColumnCount() - column);
+		if (column < 0 || n <= 0) {
+			return null;
+		}
+
+		AccessibleContext[] cells = new AccessibleContext[n];
+		for (int i = 0; i < n; i++) {
+			cells[i] = ref_at(row, column + i);
+		}
+
+		return cells;
+	}
+
 	public int get_index_at (int row, int column) {
 		int index = -1;
 